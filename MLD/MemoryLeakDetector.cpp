@@ -1,5 +1,14 @@
 #include "MemoryLeakDetector.h"
 
+#include <mutex>
+
+// guards the map, since new and delete may be called from several threads;
+// std::mutex is constant initialized, so it is usable before main()
+static std::mutex track_mutex;
+// running totals of every operator new, guarded by track_mutex
+static std::size_t allocation_count = 0;
+static std::size_t allocated_bytes = 0;
+
 track_type* get_map() {
   // don't use normal new to avoid infinite recursion.
   static track_type* track = new (std::malloc(sizeof *track)) track_type;
@@ -13,14 +22,32 @@ void* operator new(std::size_t size) noexcept(false) {
   if (mem == 0) {
     throw std::bad_alloc();
   }
+  std::lock_guard<std::mutex> lock(track_mutex);
   (*get_map())[mem] = size;
+  allocation_count++;
+  allocated_bytes += size;
   return mem;
 }
 
+std::size_t get_allocation_count() {
+  std::lock_guard<std::mutex> lock(track_mutex);
+  return allocation_count;
+}
+
+std::size_t get_allocated_bytes() {
+  std::lock_guard<std::mutex> lock(track_mutex);
+  return allocated_bytes;
+}
+
 void operator delete(void* mem) noexcept {
-  if (get_map()->erase(mem) == 0) {
+  bool tracked;
+  {
+    std::lock_guard<std::mutex> lock(track_mutex);
+    tracked = get_map()->erase(mem) != 0;
+  }
+  if (!tracked) {
     // this indicates a serious bug
     std::cerr << "bug: memory at " << mem << " wasn't allocated by us\n";
   }
   std::free(mem);
-}
\ No newline at end of file
+}
@@ -42,4 +42,10 @@ struct track_printer {
 
 track_type* get_map();
 
+// Number of calls to operator new since the program started, and the
+// total bytes they asked for; take the difference of two readings to
+// count the allocations of a piece of code
+std::size_t get_allocation_count();
+std::size_t get_allocated_bytes();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,252 @@
+//
+//  bench.cpp
+//
+//  Measures how fast each loader in csv.cpp ingests CSV files of the
+//  STATION,NAME,DATE,DX32,DX90,TAVG,TMAX,TMIN format, using synthetic
+//  files from a few MB up to several GB.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+// Usage: assignment01_bench [--repeat N] [--threads N] [--keep] [size in MB ...]
+// Sizes default to 1, 16 and 128 MB; pass e.g. "1024 4096" for multi-GB runs
+// Each file is written as bench_<size>MB.csv next to the executable and
+// removed afterwards unless --keep is given
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>  // for remove(), snprintf()
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MemoryLeakDetector.h"
+#include "Snapshot.h"
+#include "csv.h"
+
+using namespace std;
+using namespace csi281;
+
+// Years written for every synthetic station, like a long NOAA record
+static const int FIRST_YEAR = 1900;
+static const int YEARS_PER_STATION = 120;
+// Bytes written to the file at a time while generating it
+static const size_t WRITE_BUFFER_BYTES = 1 << 20;
+
+// Write a CSV of about *targetBytes* bytes with the same header and
+// quoting as tempdata.csv, returning how many data rows it holds
+// The values are random but the same on every run; about one row in a
+// hundred has a blank TMAX, as in the real data
+static long long generateCsv(const string &fileName, size_t targetBytes) {
+  ofstream file(fileName, ios::binary);
+  mt19937 rng(281);
+  uniform_int_distribution<int> below32(0, 150);
+  uniform_int_distribution<int> above90(0, 60);
+  uniform_int_distribution<int> average(300, 750);  // tenths of a degree
+  uniform_int_distribution<int> spread(50, 120);
+  uniform_int_distribution<int> percent(0, 99);
+
+  string buffer = "\"STATION\",\"NAME\",\"DATE\",\"DX32\",\"DX90\",\"TAVG\",\"TMAX\",\"TMIN\"\n";
+  size_t written = 0;
+  long long rows = 0;
+  char line[160];
+  for (int station = 0; written + buffer.size() < targetBytes; station++) {
+    for (int i = 0; i < YEARS_PER_STATION && written + buffer.size() < targetBytes; i++) {
+      int avg = average(rng);
+      int high = avg + spread(rng);
+      int low = avg - spread(rng);
+      char maxCell[16] = "";
+      if (percent(rng) != 0) {
+        snprintf(maxCell, sizeof(maxCell), "%d.%d", high / 10, high % 10);
+      }
+      int length = snprintf(line, sizeof(line),
+                            "\"USW%08d\",\"SYNTHETIC STATION %d\",\"%d\",\"%d\",\"%d\",\"%d.%d\","
+                            "\"%s\",\"%d.%d\"\n",
+                            station, station, FIRST_YEAR + i, below32(rng), above90(rng),
+                            avg / 10, avg % 10, maxCell, low / 10, low % 10);
+      buffer.append(line, length);
+      rows++;
+      if (buffer.size() >= WRITE_BUFFER_BYTES) {
+        file.write(buffer.data(), buffer.size());
+        written += buffer.size();
+        buffer.clear();
+      }
+    }
+  }
+  file.write(buffer.data(), buffer.size());
+  return rows;
+}
+
+// What one run of a loader cost
+struct Measurement {
+  double seconds;
+  size_t allocations;
+  size_t allocatedBytes;
+};
+
+// Run *load* *repeat* times, keeping the fastest time; allocations are
+// counted on the first run (every run allocates the same)
+template <typename Loader> static Measurement measure(int repeat, Loader load) {
+  Measurement best = {0, 0, 0};
+  for (int r = 0; r < repeat; r++) {
+    size_t allocations = get_allocation_count();
+    size_t bytes = get_allocated_bytes();
+    auto start = chrono::steady_clock::now();
+    load();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    if (r == 0) {
+      best = {elapsed.count(), get_allocation_count() - allocations, get_allocated_bytes() - bytes};
+    } else {
+      best.seconds = min(best.seconds, elapsed.count());
+    }
+  }
+  return best;
+}
+
+static void printHeader() {
+  cout << left << setw(10) << "size" << setw(34) << "loader" << right << setw(12) << "rows"
+       << setw(12) << "seconds" << setw(14) << "rows/sec" << setw(10) << "MB/sec" << setw(14)
+       << "allocations" << setw(12) << "alloc MB" << endl;
+}
+
+static string threadLabel(int numThreads) {
+  return to_string(numThreads) + (numThreads == 1 ? " thread" : " threads");
+}
+
+// Print one line of results; *rows* is how many rows the loader returned,
+// which every loader must agree on
+static void printRow(const string &size, const string &loader, long long rows, double megabytes,
+                     const Measurement &m) {
+  double seconds = max(m.seconds, 1e-9);
+  cout << left << setw(10) << size << setw(34) << loader << right << setw(12) << rows << fixed
+       << setprecision(4) << setw(12) << m.seconds << setprecision(0) << setw(14)
+       << rows / seconds << setprecision(1) << setw(10) << megabytes / seconds << setw(14)
+       << m.allocations << setw(12) << m.allocatedBytes / (1024.0 * 1024.0) << endl;
+  cout.unsetf(ios::fixed);
+}
+
+// Time every loader on a freshly generated file of *sizeMB* megabytes
+static void benchmarkSize(int sizeMB, int repeat, int numThreads, bool keep) {
+  string fileName = "bench_" + to_string(sizeMB) + "MB.csv";
+  string snapshotName = "bench_" + to_string(sizeMB) + "MB.snapshot";
+  long long rows = generateCsv(fileName, static_cast<size_t>(sizeMB) * 1024 * 1024);
+  double megabytes = static_cast<double>(MappedFile(fileName).size()) / (1024.0 * 1024.0);
+  string size = to_string(sizeMB) + " MB";
+  vector<int> threadCounts = {1};
+  if (numThreads > 1) {
+    threadCounts.push_back(numThreads);
+  }
+  int lastLine = static_cast<int>(rows);
+  long long loaded = 0;  // printed after every loader so none can be optimized away
+
+  // the original stream path: one getline() and parseLine() per row
+  Measurement m = measure(repeat, [&] {
+    ifstream file(fileName);
+    string header;
+    getline(file, header);
+    CityYear cy;
+    loaded = 0;
+    while (file.peek() != EOF) {
+      readLine(file, cy);
+      loaded++;
+    }
+  });
+  printRow(size, "readLine (ifstream)", loaded, megabytes, m);
+
+  m = measure(repeat, [&] {
+    MappedFile file(fileName);
+    CityYear *years = new CityYear[rows];
+    loaded = parseCityYears(file.view(), 1, lastLine, years);
+    delete[] years;
+  });
+  printRow(size, "parseCityYears (CityYear[])", loaded, megabytes, m);
+
+  for (int t : threadCounts) {
+    m = measure(repeat, [&] {
+      CityTemperatureData *city = readCity("Bench", fileName, 1, lastLine, t);
+      loaded = city->count();
+      delete city;
+    });
+    printRow(size, "readCity (" + threadLabel(t) + ")", loaded, megabytes, m);
+  }
+
+  for (int t : threadCounts) {
+    m = measure(repeat, [&] {
+      CityDataset *dataset = readDataset(fileName, t);
+      loaded = 0;
+      for (int i = 0; i < dataset->count(); i++) {
+        loaded += (*dataset)[i].count();
+      }
+      delete dataset;
+    });
+    printRow(size, "readDataset (" + threadLabel(t) + ")", loaded, megabytes, m);
+  }
+
+  // the snapshot is built outside the timing, as loadCities() would on a first run
+  CityDataset *dataset = readDataset(fileName, numThreads);
+  saveSnapshot(snapshotName, *dataset);
+  delete dataset;
+  m = measure(repeat, [&] {
+    CitySnapshot *snapshot = openSnapshot(snapshotName);
+    loaded = 0;
+    for (int i = 0; snapshot != nullptr && i < snapshot->count(); i++) {
+      loaded += (*snapshot)[i].count();
+    }
+    delete snapshot;
+  });
+  printRow(size, "openSnapshot (mapped)", loaded, megabytes, m);
+
+  if (!keep) {
+    remove(fileName.c_str());
+    remove(snapshotName.c_str());
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int repeat = 3;
+  int numThreads = static_cast<int>(max(thread::hardware_concurrency(), 1u));
+  bool keep = false;
+  vector<int> sizes;
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--repeat" && i + 1 < argc) {
+      repeat = max(stoi(argv[++i]), 1);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      numThreads = max(stoi(argv[++i]), 1);
+    } else if (arg == "--keep") {
+      keep = true;
+    } else {
+      sizes.push_back(stoi(arg));
+    }
+  }
+  if (sizes.empty()) {
+    sizes = {1, 16, 128};
+  }
+
+  printHeader();
+  for (int sizeMB : sizes) {
+    benchmarkSize(sizeMB, repeat, numThreads, keep);
+  }
+}
@@ -0,0 +1,133 @@
+//
+//  CityDataset.cpp
+//
+//  Implementation of CityDataset
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CityDataset.h"
+
+#include <utility>  // for move()
+
+using namespace std;
+
+namespace csi281 {
+  // Make room for exactly *numRows* rows in every column
+  void CityRows::resize(int numRows) {
+    years.resize(numRows);
+    daysBelow32.resize(numRows);
+    daysAbove90.resize(numRows);
+    averageTemperatures.resize(numRows);
+    averageMaxes.resize(numRows);
+    averageMins.resize(numRows);
+  }
+
+  // Add *cy* as a new row at the end of every column
+  void CityRows::push_back(const CityYear &cy) {
+    years.push_back(cy.year);
+    daysBelow32.push_back(cy.numDaysBelow32);
+    daysAbove90.push_back(cy.numDaysAbove90);
+    averageTemperatures.push_back(cy.averageTemperature);
+    averageMaxes.push_back(cy.averageMax);
+    averageMins.push_back(cy.averageMin);
+  }
+
+  // Columns to write rows into; invalidated by resize() and push_back()
+  CityColumns CityRows::columns() {
+    CityColumns columns;
+    columns.years = years.data();
+    columns.daysBelow32 = daysBelow32.data();
+    columns.daysAbove90 = daysAbove90.data();
+    columns.averageTemperatures = averageTemperatures.data();
+    columns.averageMaxes = averageMaxes.data();
+    columns.averageMins = averageMins.data();
+    return columns;
+  }
+
+  // Group the rows by station (usually already the case, so they are
+  // simply adopted) and create a view of each station's slice, with its
+  // running totals in a slice of one shared array too
+  CityDataset::CityDataset(vector<StationEntry> stations, CityRows rows,
+                           const vector<int> &rowStations)
+      : _stations(move(stations)) {
+    // where each station's slice starts once the rows are grouped
+    vector<int> firstRows(_stations.size() + 1, 0);
+    bool grouped = true;
+    for (size_t row = 0; row < rowStations.size(); row++) {
+      firstRows[rowStations[row] + 1]++;
+      if (row > 0 && rowStations[row] < rowStations[row - 1]) {
+        grouped = false;
+      }
+    }
+    for (size_t i = 0; i < _stations.size(); i++) {
+      firstRows[i + 1] += firstRows[i];
+      _stations[i].rowCount = firstRows[i + 1] - firstRows[i];
+    }
+
+    if (grouped) {
+      _rows = move(rows);
+    } else {
+      // a stable counting sort of the rows by station
+      _rows.resize(rows.size());
+      vector<int> nextRows(firstRows.begin(), firstRows.end() - 1);
+      for (size_t row = 0; row < rowStations.size(); row++) {
+        int destination = nextRows[rowStations[row]]++;
+        _rows.years[destination] = rows.years[row];
+        _rows.daysBelow32[destination] = rows.daysBelow32[row];
+        _rows.daysAbove90[destination] = rows.daysAbove90[row];
+        _rows.averageTemperatures[destination] = rows.averageTemperatures[row];
+        _rows.averageMaxes[destination] = rows.averageMaxes[row];
+        _rows.averageMins[destination] = rows.averageMins[row];
+      }
+    }
+
+    // every station's running totals, one after another, each taking
+    // NUM_RUNNING_TOTALS arrays of one more entry than it has rows
+    const int numTotals = CityTemperatureData::NUM_RUNNING_TOTALS;
+    _runningTotals.resize(static_cast<size_t>(numTotals) * (_rows.size() + _stations.size()));
+
+    _cities.reserve(_stations.size());
+    for (size_t i = 0; i < _stations.size(); i++) {
+      int first = firstRows[i];
+      double *totals = _runningTotals.data() + static_cast<size_t>(numTotals) * (first + i);
+      _cities.emplace_back(_stations[i].name, _rows.years.data() + first,
+                           _rows.daysBelow32.data() + first, _rows.daysAbove90.data() + first,
+                           _rows.averageTemperatures.data() + first,
+                           _rows.averageMaxes.data() + first, _rows.averageMins.data() + first,
+                           _stations[i].rowCount, totals);
+      _stationIndex[_stations[i].station] = static_cast<int>(i);
+    }
+  }
+
+  // Look up a city by its STATION id; nullptr if it is not in the dataset
+  CityTemperatureData *CityDataset::find(const string &station) {
+    auto found = _stationIndex.find(station);
+    if (found == _stationIndex.end()) {
+      return nullptr;
+    }
+    return &_cities[found->second];
+  }
+
+  const CityTemperatureData *CityDataset::find(const string &station) const {
+    return const_cast<CityDataset *>(this)->find(station);
+  }
+}  // namespace csi281
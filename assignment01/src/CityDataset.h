@@ -0,0 +1,98 @@
+//
+//  CityDataset.h
+//
+//  Defines the StationEntry struct and the CityDataset class, which holds
+//  every city read from one CSV file.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef CityDataset_hpp
+#define CityDataset_hpp
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CityTemperatureData.h"
+#include "MemoryLeakDetector.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Where the rows of one station live in the CSV
+  struct StationEntry {
+    string station;  // contents of the STATION column
+    string name;     // contents of the NAME column
+    size_t offset;   // byte offset of the station's first row
+    int rowCount;    // number of rows that belong to the station
+  };
+
+  // Every row of every city, stored as one growable array per column
+  // This is the arena the cities of a CityDataset point into
+  struct CityRows {
+    int size() const { return static_cast<int>(years.size()); }
+    void resize(int numRows);
+    void push_back(const CityYear &cy);
+    // Columns to write rows into; invalidated by resize() and push_back()
+    CityColumns columns();
+
+    vector<int> years;
+    vector<int> daysBelow32;
+    vector<int> daysAbove90;
+    vector<float> averageTemperatures;
+    vector<float> averageMaxes;
+    vector<float> averageMins;
+  };
+
+  // All of the cities read from a single CSV, indexed by station
+  // Every city's years live in one shared CityRows arena, and their
+  // running totals in one shared array; each CityTemperatureData is only
+  // a view of its slices of the two
+  class CityDataset {
+  public:
+    // Build the dataset out of *rows*, where row i belongs to the station
+    // stations[rowStations[i]]; the rows are adopted, not copied, unless the
+    // rows of some station are not next to each other and must be regrouped
+    CityDataset(vector<StationEntry> stations, CityRows rows, const vector<int> &rowStations);
+    CityDataset(const CityDataset &) = delete;
+    CityDataset &operator=(const CityDataset &) = delete;
+
+    int count() const { return static_cast<int>(_cities.size()); }
+    const StationEntry &getStation(int index) const { return _stations[index]; }
+    CityTemperatureData &operator[](int index) { return _cities[index]; }
+    const CityTemperatureData &operator[](int index) const { return _cities[index]; }
+    // Look up a city by its STATION id; nullptr if it is not in the dataset
+    CityTemperatureData *find(const string &station);
+    const CityTemperatureData *find(const string &station) const;
+
+  private:
+    vector<StationEntry> _stations;            // index of every station, in file order
+    CityRows _rows;                            // every station's rows, one station after another
+    vector<double> _runningTotals;             // every station's running totals, likewise
+    vector<CityTemperatureData> _cities;       // view of each station's rows
+    unordered_map<string, int> _stationIndex;  // STATION id to position in _stations
+  };
+}  // namespace csi281
+
+#endif /* CityDataset_hpp */
@@ -26,64 +26,503 @@
 //  OTHER DEALINGS IN THE SOFTWARE.
 
 #include "CityTemperatureData.h"
+#include <algorithm>  // for lower_bound(), upper_bound(), min(), max(), copy()
+#include <cmath>      // for isnan(), fmax(), fmin()
+#include <limits>
 #include <stdexcept>
+#include <utility>    // for move()
+
+#include "columns.h"
 
 using namespace std;
 
 namespace csi281 {
+  // Years the first append() to an empty or wrapped city makes room for
+  static const int MIN_APPEND_CAPACITY = 8;
+
+  // A float reading for summing, with a missing (NaN) one counting as 0
+  static double reading(const float value) { return isnan(value) ? 0 : value; }
+
+  // 1 for a float reading that is there, 0 for a missing one
+  static double present(const float value) { return isnan(value) ? 0 : 1; }
+
   // Fill in all instance variables for CityTemperatureData.
-  // Data will be stored in an array of CityYear instances.
-  CityTemperatureData::CityTemperatureData(const string name, CityYear data[], int numYears) : _name(name), _count(numYears) {
-      _data = new CityYear[numYears];
-      for (int i = 0; i < numYears; i++) {
-          _data[i] = data[i];
+  // Data is split into one array per field of CityYear.
+  CityTemperatureData::CityTemperatureData(const string name, CityYear data[], int numYears)
+      : _name(name), _count(numYears), _capacity(numYears) {
+    _intColumns = new int[3 * numYears];
+    _floatColumns = new float[3 * numYears];
+    CityColumns columns(_intColumns, _floatColumns, numYears);
+    for (int i = 0; i < numYears; i++) {
+      columns.set(i, data[i]);
+    }
+    setColumns(columns);
+  }
+
+  // Take ownership of columns that were filled in elsewhere.
+  CityTemperatureData::CityTemperatureData(const string name, int* intColumns,
+                                           float* floatColumns, int capacity, int numYears)
+      : _name(name),
+        _count(numYears),
+        _capacity(capacity),
+        _intColumns(intColumns),
+        _floatColumns(floatColumns) {
+    setColumns(CityColumns(intColumns, floatColumns, capacity));
+  }
+
+  // Take over everything *other* owns, leaving it empty.
+  CityTemperatureData::CityTemperatureData(CityTemperatureData &&other) noexcept
+      : _name(move(other._name)),
+        _count(other._count),
+        _capacity(other._capacity),
+        _intColumns(other._intColumns),
+        _floatColumns(other._floatColumns),
+        _years(other._years),
+        _daysBelow32(other._daysBelow32),
+        _daysAbove90(other._daysAbove90),
+        _averageTemperatures(other._averageTemperatures),
+        _averageMaxes(other._averageMaxes),
+        _averageMins(other._averageMins),
+        _consecutive(other._consecutive),
+        _ascending(other._ascending),
+        _temperatureTotal(other._temperatureTotal),
+        _temperatureCount(other._temperatureCount),
+        _totalBelow32(other._totalBelow32),
+        _totalAbove90(other._totalAbove90),
+        _highestAverageMax(other._highestAverageMax),
+        _lowestAverageMin(other._lowestAverageMin),
+        _ownedPrefixSums(other._ownedPrefixSums),
+        _prefixSums(other._prefixSums),
+        _prefixStride(other._prefixStride) {
+    other._count = 0;
+    other._capacity = 0;
+    other._intColumns = nullptr;
+    other._floatColumns = nullptr;
+    other._ownedPrefixSums = nullptr;
+    other._prefixSums = nullptr;
+  }
+
+  // Wrap columns that live somewhere else without copying them.
+  CityTemperatureData::CityTemperatureData(const string name, const int years[],
+                                           const int daysBelow32[], const int daysAbove90[],
+                                           const float averageTemperatures[],
+                                           const float averageMaxes[], const float averageMins[],
+                                           int numYears)
+      : _name(name),
+        _count(numYears),
+        _capacity(0),
+        _intColumns(nullptr),
+        _floatColumns(nullptr) {
+    setColumns(years, daysBelow32, daysAbove90, averageTemperatures, averageMaxes, averageMins);
+  }
+
+  // Wrap columns, building their running totals in storage that lives
+  // somewhere else.
+  CityTemperatureData::CityTemperatureData(const string name, const int years[],
+                                           const int daysBelow32[], const int daysAbove90[],
+                                           const float averageTemperatures[],
+                                           const float averageMaxes[], const float averageMins[],
+                                           int numYears, double runningTotals[])
+      : _name(name),
+        _count(numYears),
+        _capacity(0),
+        _intColumns(nullptr),
+        _floatColumns(nullptr),
+        _years(years),
+        _daysBelow32(daysBelow32),
+        _daysAbove90(daysAbove90),
+        _averageTemperatures(averageTemperatures),
+        _averageMaxes(averageMaxes),
+        _averageMins(averageMins),
+        _prefixSums(runningTotals),
+        _prefixStride(numYears + 1) {
+    findYearLayout();
+    findAggregates();
+    fillPrefixSums(runningTotals, _prefixStride);
+  }
+
+  // Wrap columns along with everything already worked out from them.
+  CityTemperatureData::CityTemperatureData(const string name, const int years[],
+                                           const int daysBelow32[], const int daysAbove90[],
+                                           const float averageTemperatures[],
+                                           const float averageMaxes[], const float averageMins[],
+                                           int numYears, const CitySummary &summary,
+                                           const double runningTotals[])
+      : _name(name),
+        _count(numYears),
+        _capacity(0),
+        _intColumns(nullptr),
+        _floatColumns(nullptr),
+        _years(years),
+        _daysBelow32(daysBelow32),
+        _daysAbove90(daysAbove90),
+        _averageTemperatures(averageTemperatures),
+        _averageMaxes(averageMaxes),
+        _averageMins(averageMins),
+        _consecutive(summary.consecutive),
+        _ascending(summary.ascending),
+        _temperatureTotal(summary.temperatureTotal),
+        _temperatureCount(summary.temperatureCount),
+        _totalBelow32(summary.totalBelow32),
+        _totalAbove90(summary.totalAbove90),
+        _highestAverageMax(summary.highestAverageMax),
+        _lowestAverageMin(summary.lowestAverageMin),
+        _prefixSums(runningTotals),
+        _prefixStride(numYears + 1) {}
+
+  // Point every column at its data, work out how years map to positions
+  // and compute the whole-history aggregates and the running totals.
+  void CityTemperatureData::setColumns(const CityColumns &columns) {
+    setColumns(columns.years, columns.daysBelow32, columns.daysAbove90,
+               columns.averageTemperatures, columns.averageMaxes, columns.averageMins);
+  }
+
+  void CityTemperatureData::setColumns(const int years[], const int daysBelow32[],
+                                       const int daysAbove90[], const float averageTemperatures[],
+                                       const float averageMaxes[], const float averageMins[]) {
+    _years = years;
+    _daysBelow32 = daysBelow32;
+    _daysAbove90 = daysAbove90;
+    _averageTemperatures = averageTemperatures;
+    _averageMaxes = averageMaxes;
+    _averageMins = averageMins;
+    findYearLayout();
+    findAggregates();
+    buildPrefixSums();
+  }
+
+  // Compute every cached aggregate from scratch; append() keeps them current after this
+  void CityTemperatureData::findAggregates() {
+    _temperatureTotal = columnSum(_averageTemperatures, _count);
+    _temperatureCount = columnCount(_averageTemperatures, _count);
+    _totalBelow32 = columnSum(_daysBelow32, _count);
+    _totalAbove90 = columnSum(_daysAbove90, _count);
+    // NaN if there are no years, or none with a reading
+    _highestAverageMax = columnMax(_averageMaxes, _count);
+    _lowestAverageMin = columnMin(_averageMins, _count);
+  }
+
+  // Compute the running totals of every summed column from scratch,
+  // leaving room for the years the owned columns can still take
+  void CityTemperatureData::buildPrefixSums() {
+    delete[] _ownedPrefixSums;
+    _prefixStride = max(_capacity, _count) + 1;
+    _ownedPrefixSums = new double[NUM_SUMMED_COLUMNS * _prefixStride];
+    _prefixSums = _ownedPrefixSums;
+    fillPrefixSums(_ownedPrefixSums, _prefixStride);
+  }
+
+  // Write the running totals of every summed column into *sums*, one
+  // array every *stride* entries
+  void CityTemperatureData::fillPrefixSums(double sums[], const int stride) const {
+    for (int c = 0; c < NUM_SUMMED_COLUMNS; c++) {
+      double* column = sums + c * stride;
+      column[0] = 0;
+      for (int i = 0; i < _count; i++) {
+        column[i + 1] = column[i] + valueAt(static_cast<SummedColumn>(c), i);
       }
+    }
+  }
+
+  // Move the columns into owned storage of *newCapacity* entries each,
+  // releasing the old storage if it was owned
+  void CityTemperatureData::growColumns(const int newCapacity) {
+    int* intColumns = new int[3 * newCapacity];
+    float* floatColumns = new float[3 * newCapacity];
+    CityColumns grown(intColumns, floatColumns, newCapacity);
+    copy(_years, _years + _count, grown.years);
+    copy(_daysBelow32, _daysBelow32 + _count, grown.daysBelow32);
+    copy(_daysAbove90, _daysAbove90 + _count, grown.daysAbove90);
+    copy(_averageTemperatures, _averageTemperatures + _count, grown.averageTemperatures);
+    copy(_averageMaxes, _averageMaxes + _count, grown.averageMaxes);
+    copy(_averageMins, _averageMins + _count, grown.averageMins);
+
+    delete[] _intColumns;
+    delete[] _floatColumns;
+    _intColumns = intColumns;
+    _floatColumns = floatColumns;
+    _capacity = newCapacity;
+    _years = grown.years;
+    _daysBelow32 = grown.daysBelow32;
+    _daysAbove90 = grown.daysAbove90;
+    _averageTemperatures = grown.averageTemperatures;
+    _averageMaxes = grown.averageMaxes;
+    _averageMins = grown.averageMins;
+  }
+
+  // Make room for at least *numYears* years without further growth
+  void CityTemperatureData::reserve(const int numYears) {
+    if (numYears > _capacity) {
+      growColumns(max(numYears, _count));
+    }
+  }
+
+  // Add *cy* after the last year, doubling the owned columns when they are
+  // full and updating the year layout, the cached aggregates and the
+  // running totals without revisiting earlier years
+  void CityTemperatureData::append(const CityYear &cy) {
+    if (_count >= _capacity) {
+      growColumns(max(2 * max(_capacity, _count), MIN_APPEND_CAPACITY));
+    }
+    CityColumns(_intColumns, _floatColumns, _capacity).set(_count, cy);
+
+    if (_count > 0) {
+      int lastYear = _years[_count - 1];
+      if (cy.year != lastYear + 1) {
+        _consecutive = false;
+      }
+      if (cy.year <= lastYear) {
+        _ascending = false;
+      }
+    }
+    // fmax() and fmin() pass over a NaN on either side
+    _highestAverageMax = fmax(_highestAverageMax, cy.averageMax);
+    _lowestAverageMin = fmin(_lowestAverageMin, cy.averageMin);
+    if (!isnan(cy.averageTemperature)) {
+      _temperatureTotal += cy.averageTemperature;
+      _temperatureCount++;
+    }
+    _totalBelow32 += cy.numDaysBelow32;
+    _totalAbove90 += cy.numDaysAbove90;
+
+    if (_ownedPrefixSums == nullptr || _prefixStride < _count + 2) {
+      // the running totals grow along with the columns, and wrapped ones
+      // are copied into owned storage
+      int stride = _capacity + 1;
+      double* prefixSums = new double[NUM_SUMMED_COLUMNS * stride];
+      for (int c = 0; c < NUM_SUMMED_COLUMNS; c++) {
+        copy(_prefixSums + c * _prefixStride, _prefixSums + c * _prefixStride + _count + 1,
+             prefixSums + c * stride);
+      }
+      delete[] _ownedPrefixSums;
+      _ownedPrefixSums = prefixSums;
+      _prefixSums = prefixSums;
+      _prefixStride = stride;
+    }
+    for (int c = 0; c < NUM_SUMMED_COLUMNS; c++) {
+      double* sums = _ownedPrefixSums + c * _prefixStride;
+      sums[_count + 1] = sums[_count] + valueAt(static_cast<SummedColumn>(c), _count);
+    }
+    _count++;
   }
 
   // Release any memory connected to CityTemperatureData.
   CityTemperatureData::~CityTemperatureData() {
-    delete[] _data;
+    delete[] _intColumns;
+    delete[] _floatColumns;
+    delete[] _ownedPrefixSums;
+  }
+
+  // Everything the constructors work out from the columns
+  CitySummary CityTemperatureData::summary() const {
+    return {_consecutive,  _ascending,    _temperatureTotal,  _temperatureCount,
+            _totalBelow32, _totalAbove90, _highestAverageMax, _lowestAverageMin};
+  }
+
+  // Work out whether a year can be turned straight into an index
+  // (a gapless run of years) or at least binary searched (ascending)
+  void CityTemperatureData::findYearLayout() {
+    _consecutive = true;
+    _ascending = true;
+    for (int i = 1; i < _count; i++) {
+      if (_years[i] != _years[i - 1] + 1) {
+        _consecutive = false;
+      }
+      if (_years[i] <= _years[i - 1]) {
+        _ascending = false;
+      }
+    }
+  }
+
+  // Position of *year* in the columns, or -1 if the city has no data for it
+  // O(1) for a gapless run of years, O(log n) for ascending years with
+  // gaps, and a linear scan for anything else
+  int CityTemperatureData::indexOf(const int year) const {
+    if (_count == 0) {
+      return -1;
+    }
+    if (_consecutive) {
+      int index = year - _years[0];
+      return (index >= 0 && index < _count) ? index : -1;
+    }
+    if (_ascending) {
+      const int* found = lower_bound(_years, _years + _count, year);
+      return (found != _years + _count && *found == year) ? static_cast<int>(found - _years) : -1;
+    }
+    for (int i = 0; i < _count; i++) {
+      if (year == _years[i]) {
+        return i;
+      }
+    }
+    return -1;
   }
 
   // Look up a CityYear instance held by CityTemperatureData by its year.
-  // Find the right CityYear in the array and return it
+  // Find the right year in the year column and gather its fields
   const CityYear CityTemperatureData::operator[](const int year) const {
-    for (int i = 0; i < _count; i++) {
-      if (year == _data[i].year)
-        return _data[i];
+    int i = indexOf(year);
+    if (i == -1) {
+      throw out_of_range("Year not found");
     }
 
-    throw out_of_range("Year not found");
+    return {_years[i],
+            _daysBelow32[i],
+            _daysAbove90[i],
+            _averageTemperatures[i],
+            _averageMaxes[i],
+            _averageMins[i]};
   }
 
   // Get the average (mean) temperature of all time for this city
-  // by averaging every CityYear.
+  // by averaging every CityYear that has one.
   float CityTemperatureData::getAllTimeAverage() const {
-    float total = 0;
-    for (int i = 0; i < _count; i++) {
-      total += _data[i].averageTemperature;
-    }
-
-    return total / _count;
+    return _temperatureTotal / _temperatureCount;
   }
 
   // Sum all of the days below 32 for all years.
   int CityTemperatureData::getTotalDaysBelow32() const {
-    int sum = 0;
-    for (int i = 0; i < _count; i++) {
-      sum += _data[i].numDaysBelow32;
-    }
-
-    return sum;
+    return _totalBelow32;
   }
 
   // Sum all of the days above 90 for all years.
   int CityTemperatureData::getTotalDaysAbove90() const {
-    int sum = 0;
+    return _totalAbove90;
+  }
+
+  // The warmest yearly average high of all years.
+  float CityTemperatureData::getHighestAverageMax() const {
+    return _highestAverageMax;
+  }
+
+  // The coldest yearly average low of all years.
+  float CityTemperatureData::getLowestAverageMin() const {
+    return _lowestAverageMin;
+  }
+
+  // The value of *column* for the year at *index*, with a missing
+  // reading counting as 0
+  double CityTemperatureData::valueAt(const SummedColumn column, const int index) const {
+    switch (column) {
+      case DAYS_BELOW_32:
+        return _daysBelow32[index];
+      case DAYS_ABOVE_90:
+        return _daysAbove90[index];
+      case AVERAGE_TEMPERATURE:
+        return reading(_averageTemperatures[index]);
+      case AVERAGE_MAX:
+        return reading(_averageMaxes[index]);
+      case AVERAGE_MIN:
+        return reading(_averageMins[index]);
+      case TEMPERATURES_PRESENT:
+        return present(_averageTemperatures[index]);
+      case MAXES_PRESENT:
+        return present(_averageMaxes[index]);
+      default:
+        return present(_averageMins[index]);
+    }
+  }
+
+  // The column counting which readings of *column* are there, or
+  // NUM_SUMMED_COLUMNS for the int columns, which are never missing
+  CityTemperatureData::SummedColumn CityTemperatureData::presentColumn(
+      const SummedColumn column) {
+    switch (column) {
+      case AVERAGE_TEMPERATURE:
+        return TEMPERATURES_PRESENT;
+      case AVERAGE_MAX:
+        return MAXES_PRESENT;
+      case AVERAGE_MIN:
+        return MINS_PRESENT;
+      default:
+        return NUM_SUMMED_COLUMNS;
+    }
+  }
+
+  // Find the positions [first, last) of the years from *fromYear* to
+  // *toYear* inclusive; only meaningful when the years are ascending
+  void CityTemperatureData::findRange(const int fromYear, const int toYear, int &first,
+                                      int &last) const {
+    if (_consecutive && _count > 0) {
+      // widen to long long so extreme years can not overflow
+      long long firstYear = _years[0];
+      first = static_cast<int>(min<long long>(max<long long>(fromYear - firstYear, 0), _count));
+      last = static_cast<int>(min<long long>(max<long long>(toYear - firstYear + 1, 0), _count));
+    } else {
+      first = static_cast<int>(lower_bound(_years, _years + _count, fromYear) - _years);
+      last = static_cast<int>(upper_bound(_years, _years + _count, toYear) - _years);
+    }
+    if (last < first) {
+      last = first;
+    }
+  }
+
+  // Total of *column* over the positions [first, last) in O(1)
+  double CityTemperatureData::sumRange(const SummedColumn column, const int first,
+                                       const int last) const {
+    const double* sums = _prefixSums + column * _prefixStride;
+    return sums[last] - sums[first];
+  }
+
+  // Total of *column* over the years from *fromYear* to *toYear* inclusive,
+  // also giving how many of those years had a reading
+  double CityTemperatureData::sumYears(const SummedColumn column, const int fromYear,
+                                       const int toYear, int &numYears) const {
+    const SummedColumn counted = presentColumn(column);
+    if (_ascending) {
+      int first, last;
+      findRange(fromYear, toYear, first, last);
+      numYears = counted == NUM_SUMMED_COLUMNS ? last - first
+                                               : static_cast<int>(sumRange(counted, first, last));
+      return sumRange(column, first, last);
+    }
+
+    // unordered years have no contiguous range, so fall back to a scan
+    double total = 0;
+    numYears = 0;
     for (int i = 0; i < _count; i++) {
-      sum += _data[i].numDaysAbove90;
+      if (_years[i] >= fromYear && _years[i] <= toYear) {
+        total += valueAt(column, i);
+        numYears += counted == NUM_SUMMED_COLUMNS ? 1 : static_cast<int>(valueAt(counted, i));
+      }
     }
+    return total;
+  }
+
+  // Mean of *column* over the years from *fromYear* to *toYear* inclusive
+  float CityTemperatureData::averageYears(const SummedColumn column, const int fromYear,
+                                          const int toYear) const {
+    int numYears;
+    double total = sumYears(column, fromYear, toYear, numYears);
+    if (numYears == 0) {
+      throw out_of_range("No readings in range");
+    }
+    return static_cast<float>(total / numYears);
+  }
+
+  // Average temperature over the years from *fromYear* to *toYear*.
+  float CityTemperatureData::getAverageTemperature(const int fromYear, const int toYear) const {
+    return averageYears(AVERAGE_TEMPERATURE, fromYear, toYear);
+  }
+
+  // Average high over the years from *fromYear* to *toYear*.
+  float CityTemperatureData::getAverageMax(const int fromYear, const int toYear) const {
+    return averageYears(AVERAGE_MAX, fromYear, toYear);
+  }
+
+  // Average low over the years from *fromYear* to *toYear*.
+  float CityTemperatureData::getAverageMin(const int fromYear, const int toYear) const {
+    return averageYears(AVERAGE_MIN, fromYear, toYear);
+  }
+
+  // Sum of the days below 32 over the years from *fromYear* to *toYear*.
+  int CityTemperatureData::getDaysBelow32(const int fromYear, const int toYear) const {
+    int numYears;
+    return static_cast<int>(sumYears(DAYS_BELOW_32, fromYear, toYear, numYears));
+  }
 
-    return sum;
+  // Sum of the days above 90 over the years from *fromYear* to *toYear*.
+  int CityTemperatureData::getDaysAbove90(const int fromYear, const int toYear) const {
+    int numYears;
+    return static_cast<int>(sumYears(DAYS_ABOVE_90, fromYear, toYear, numYears));
   }
-}  // namespace csi281
\ No newline at end of file
+}  // namespace csi281
@@ -46,23 +46,196 @@ namespace csi281 {
     float averageMin;
   };
 
+  // Six writable columns, one per field of CityYear, that can be
+  // filled one CityYear at a time
+  struct CityColumns {
+    CityColumns() = default;
+    // The layout CityTemperatureData owns: the int columns back to back in
+    // *intColumns* and the float columns back to back in *floatColumns*,
+    // each column *capacity* entries long
+    CityColumns(int* intColumns, float* floatColumns, int capacity)
+        : years(intColumns),
+          daysBelow32(intColumns + capacity),
+          daysAbove90(intColumns + 2 * capacity),
+          averageTemperatures(floatColumns),
+          averageMaxes(floatColumns + capacity),
+          averageMins(floatColumns + 2 * capacity) {}
+
+    // Store *cy* as the entry at *index* of every column
+    void set(int index, const CityYear& cy) const {
+      years[index] = cy.year;
+      daysBelow32[index] = cy.numDaysBelow32;
+      daysAbove90[index] = cy.numDaysAbove90;
+      averageTemperatures[index] = cy.averageTemperature;
+      averageMaxes[index] = cy.averageMax;
+      averageMins[index] = cy.averageMin;
+    }
+
+    int* years = nullptr;
+    int* daysBelow32 = nullptr;
+    int* daysAbove90 = nullptr;
+    float* averageTemperatures = nullptr;
+    float* averageMaxes = nullptr;
+    float* averageMins = nullptr;
+  };
+
+  // What CityTemperatureData works out by scanning its columns, so that
+  // columns saved along with it can be wrapped again without a rescan
+  struct CitySummary {
+    bool consecutive;         // years are first year, first year + 1, ... with no gaps
+    bool ascending;           // years are strictly increasing
+    float temperatureTotal;   // sum of every averageTemperature not missing
+    int temperatureCount;     // number of averageTemperatures not missing
+    int totalBelow32;         // sum of every numDaysBelow32
+    int totalAbove90;         // sum of every numDaysAbove90
+    float highestAverageMax;  // largest averageMax (NaN if none)
+    float lowestAverageMin;   // smallest averageMin (NaN if none)
+  };
+
   // Represents all of the data for a city in aggregate
+  // The years are stored column by column (one contiguous array per
+  // field of CityYear) so that aggregates only touch the field they need
   class CityTemperatureData {
   public:
     CityTemperatureData(const string name, CityYear data[], int numYears);
+    // Wrap columns that live somewhere else (such as a memory mapped
+    // snapshot) without copying them; they must outlive this object
+    CityTemperatureData(const string name, const int years[], const int daysBelow32[],
+                        const int daysAbove90[], const float averageTemperatures[],
+                        const float averageMaxes[], const float averageMins[], int numYears);
+    // Wrap columns together with their *summary* and running totals (as
+    // from summary() and runningTotals(), laid out back to back with
+    // numYears + 1 entries each), scanning and copying none of them
+    CityTemperatureData(const string name, const int years[], const int daysBelow32[],
+                        const int daysAbove90[], const float averageTemperatures[],
+                        const float averageMaxes[], const float averageMins[], int numYears,
+                        const CitySummary &summary, const double runningTotals[]);
+    // Wrap columns and build their running totals into *runningTotals*
+    // (room for NUM_RUNNING_TOTALS arrays of numYears + 1 entries, back to
+    // back) rather than allocating them; both must outlive this object
+    CityTemperatureData(const string name, const int years[], const int daysBelow32[],
+                        const int daysAbove90[], const float averageTemperatures[],
+                        const float averageMaxes[], const float averageMins[], int numYears,
+                        double runningTotals[]);
+    // Take ownership of columns laid out as in CityColumns(intColumns,
+    // floatColumns, capacity) and allocated with new[], without copying them
+    CityTemperatureData(const string name, int* intColumns, float* floatColumns, int capacity,
+                        int numYears);
+    CityTemperatureData(CityTemperatureData &&other) noexcept;
     ~CityTemperatureData();
+    CityTemperatureData(const CityTemperatureData &) = delete;
+    CityTemperatureData &operator=(const CityTemperatureData &) = delete;
+    CityTemperatureData &operator=(CityTemperatureData &&) = delete;
     int count() const { return _count; }
+    // Years the owned columns can hold before append() has to grow them
+    // (0 while the columns are wrapped rather than owned)
+    int capacity() const { return _capacity; }
     const string& getName() const { return _name; }
-    int getFirstYear() const { return _data[0].year; }
+    int getFirstYear() const { return _years[0]; }
     const CityYear operator[](const int year) const;
     float getAllTimeAverage() const;
     int getTotalDaysBelow32() const;
     int getTotalDaysAbove90() const;
+    float getHighestAverageMax() const;
+    float getLowestAverageMin() const;
+
+    // Add *cy* after the last year, growing the owned columns geometrically
+    // so a run of appends costs amortized O(1) each; wrapped columns are
+    // copied into owned storage on the first append
+    void append(const CityYear &cy);
+    // Make room for at least *numYears* years without further growth
+    void reserve(const int numYears);
+
+    // Position of *year* in the columns, or -1 if the city has no data for it
+    int indexOf(const int year) const;
+
+    // Aggregates over the years from *fromYear* to *toYear*, inclusive
+    // Missing (NaN) readings are left out, and averages throw out_of_range
+    // if no year in the range has a reading
+    float getAverageTemperature(const int fromYear, const int toYear) const;
+    float getAverageMax(const int fromYear, const int toYear) const;
+    float getAverageMin(const int fromYear, const int toYear) const;
+    int getDaysBelow32(const int fromYear, const int toYear) const;
+    int getDaysAbove90(const int fromYear, const int toYear) const;
+
+    // Everything the constructors work out from the columns
+    CitySummary summary() const;
+    // The NUM_RUNNING_TOTALS arrays of count() + 1 running totals that
+    // range queries are answered from; *total* is from 0 up
+    static const int NUM_RUNNING_TOTALS = 8;
+    const double* runningTotals(const int total) const {
+      return _prefixSums + total * _prefixStride;
+    }
+
+    // Each column holds one field of every year, in the same order
+    const int* years() const { return _years; }
+    const int* daysBelow32() const { return _daysBelow32; }
+    const int* daysAbove90() const { return _daysAbove90; }
+    const float* averageTemperatures() const { return _averageTemperatures; }
+    const float* averageMaxes() const { return _averageMaxes; }
+    const float* averageMins() const { return _averageMins; }
 
   private:
-    string _name;     // name of city
-    CityYear* _data;  // array of CityYear
-    int _count;       // number of years covered by the class
+    // The columns that range queries can be asked about
+    enum SummedColumn {
+      DAYS_BELOW_32,
+      DAYS_ABOVE_90,
+      AVERAGE_TEMPERATURE,
+      AVERAGE_MAX,
+      AVERAGE_MIN,
+      // how many of each float column's readings are not missing (NaN)
+      TEMPERATURES_PRESENT,
+      MAXES_PRESENT,
+      MINS_PRESENT,
+      NUM_SUMMED_COLUMNS
+    };
+    static_assert(NUM_SUMMED_COLUMNS == NUM_RUNNING_TOTALS, "one running total per column");
+
+    static SummedColumn presentColumn(const SummedColumn column);
+
+    double valueAt(const SummedColumn column, const int index) const;
+    void findRange(const int fromYear, const int toYear, int &first, int &last) const;
+    double sumRange(const SummedColumn column, const int first, const int last) const;
+    double sumYears(const SummedColumn column, const int fromYear, const int toYear,
+                    int &numYears) const;
+    float averageYears(const SummedColumn column, const int fromYear, const int toYear) const;
+    void setColumns(const CityColumns &columns);
+    void setColumns(const int years[], const int daysBelow32[], const int daysAbove90[],
+                    const float averageTemperatures[], const float averageMaxes[],
+                    const float averageMins[]);
+    void findYearLayout();
+    void findAggregates();
+    void buildPrefixSums();
+    void fillPrefixSums(double sums[], const int stride) const;
+    void growColumns(const int newCapacity);
+
+    string _name;                       // name of city
+    int _count;                         // number of years covered by the class
+    int _capacity;                      // entries per owned column (0 if wrapped)
+    int* _intColumns;                   // owned storage of the int columns (nullptr if wrapped)
+    float* _floatColumns;               // owned storage of the float columns (nullptr if wrapped)
+    const int* _years;                  // CityYear::year of every year
+    const int* _daysBelow32;            // CityYear::numDaysBelow32 of every year
+    const int* _daysAbove90;            // CityYear::numDaysAbove90 of every year
+    const float* _averageTemperatures;  // CityYear::averageTemperature of every year
+    const float* _averageMaxes;         // CityYear::averageMax of every year
+    const float* _averageMins;          // CityYear::averageMin of every year
+    bool _consecutive;                  // years are first year, first year + 1, ... with no gaps
+    bool _ascending;                    // years are strictly increasing
+    // Whole-history aggregates, kept up to date by append(); missing
+    // (NaN) readings are left out of all of them
+    float _temperatureTotal;            // sum of every averageTemperature
+    int _temperatureCount;              // number of averageTemperatures not missing
+    int _totalBelow32;                  // sum of every numDaysBelow32
+    int _totalAbove90;                  // sum of every numDaysAbove90
+    float _highestAverageMax;           // largest averageMax (NaN if no years)
+    float _lowestAverageMin;            // smallest averageMin (NaN if no years)
+    // NUM_SUMMED_COLUMNS arrays of running totals, each _prefixStride long
+    // (at least _count + 1), built with the columns (into storage of their
+    // own or the caller's, or wrapped along with them) and extended by append()
+    double* _ownedPrefixSums = nullptr;  // owned storage of _prefixSums (nullptr if wrapped)
+    const double* _prefixSums = nullptr;
+    int _prefixStride = 0;
   };
 }  // namespace csi281
 
@@ -0,0 +1,126 @@
+//
+//  MappedFile.cpp
+//
+//  Implementation of MappedFile using mmap() on POSIX systems and
+//  file mapping objects on Windows.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace csi281 {
+
+#ifdef _WIN32
+  MappedFile::MappedFile(const string &fileName) {
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return;
+    }
+    _file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+      return;
+    }
+    _size = static_cast<size_t>(size.QuadPart);
+    _open = true;
+    // a zero length file can not be mapped, but it is still a valid (empty) file
+    if (_size == 0) {
+      return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+      _open = false;
+      return;
+    }
+    _mapping = mapping;
+    _data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr) {
+      _open = false;
+      _size = 0;
+    }
+  }
+
+  MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+      UnmapViewOfFile(_data);
+    }
+    if (_mapping != nullptr) {
+      CloseHandle(_mapping);
+    }
+    if (_file != nullptr) {
+      CloseHandle(_file);
+    }
+  }
+#else
+  MappedFile::MappedFile(const string &fileName) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+      close(fd);
+      return;
+    }
+    _size = static_cast<size_t>(info.st_size);
+    _open = true;
+    // a zero length file can not be mapped, but it is still a valid (empty) file
+    if (_size > 0) {
+      void *mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        _open = false;
+        _size = 0;
+      } else {
+        _data = static_cast<const char *>(mapping);
+        // we read the file front to back exactly once
+        madvise(mapping, _size, MADV_SEQUENTIAL);
+      }
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+  }
+
+  MappedFile::~MappedFile() {
+    if (_data != nullptr) {
+      munmap(const_cast<char *>(_data), _size);
+    }
+  }
+#endif
+}  // namespace csi281
@@ -0,0 +1,67 @@
+//
+//  MappedFile.h
+//
+//  A read-only memory mapping of a whole file, so that large CSV
+//  files can be tokenized in place without copying them into strings.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef MappedFile_hpp
+#define MappedFile_hpp
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "MemoryLeakDetector.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Maps an entire file read-only into memory for as long as the
+  // MappedFile lives. The bytes are only valid during that lifetime.
+  class MappedFile {
+  public:
+    explicit MappedFile(const string &fileName);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Did the file open (an empty file is open, with size() == 0)
+    bool isOpen() const { return _open; }
+    const char *data() const { return _data; }
+    size_t size() const { return _size; }
+    string_view view() const { return string_view(_data, _size); }
+
+  private:
+    const char *_data = nullptr;  // start of the mapping
+    size_t _size = 0;             // length of the mapping in bytes
+    bool _open = false;           // was the file opened successfully
+#ifdef _WIN32
+    void *_file = nullptr;     // HANDLE of the file
+    void *_mapping = nullptr;  // HANDLE of the file mapping object
+#endif
+  };
+}  // namespace csi281
+
+#endif /* MappedFile_hpp */
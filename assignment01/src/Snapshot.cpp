@@ -0,0 +1,219 @@
+//
+//  Snapshot.cpp
+//
+//  Implementation of the binary snapshot format.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#include "Snapshot.h"
+
+#include <cstring>  // for memcpy(), memcmp()
+#include <fstream>
+
+#include "csv.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Every column entry is written and read as 4 bytes
+  static_assert(sizeof(int) == 4 && sizeof(float) == 4, "snapshot columns are 32 bit");
+
+  // Bytes of a city's running totals
+  static uint64_t totalsBytes(uint32_t numYears) {
+    return SNAPSHOT_TOTALS * (static_cast<uint64_t>(numYears) + 1) * sizeof(double);
+  }
+
+  // Round *offset* up to the next multiple of SNAPSHOT_ALIGNMENT
+  static uint64_t alignOffset(uint64_t offset) {
+    return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+  }
+
+  // Write *count* cities to a snapshot file; false if it could not be written
+  bool saveSnapshot(const string &fileName, const CityTemperatureData *const cities[], int count) {
+    // Lay out the whole file before writing any of it
+    vector<SnapshotCity> records(count);
+    uint64_t offset = sizeof(SnapshotHeader) + count * sizeof(SnapshotCity);
+    for (int i = 0; i < count; i++) {
+      records[i].nameOffset = offset;
+      records[i].nameLength = static_cast<uint32_t>(cities[i]->getName().size());
+      records[i].numYears = static_cast<uint32_t>(cities[i]->count());
+      offset += records[i].nameLength;
+
+      const CitySummary summary = cities[i]->summary();
+      records[i].layout = (summary.consecutive ? SNAPSHOT_CONSECUTIVE : 0)
+                          | (summary.ascending ? SNAPSHOT_ASCENDING : 0);
+      records[i].temperatureCount = summary.temperatureCount;
+      records[i].temperatureTotal = summary.temperatureTotal;
+      records[i].totalBelow32 = summary.totalBelow32;
+      records[i].totalAbove90 = summary.totalAbove90;
+      records[i].highestAverageMax = summary.highestAverageMax;
+      records[i].lowestAverageMin = summary.lowestAverageMin;
+      records[i].reserved = 0;
+    }
+    for (int i = 0; i < count; i++) {
+      for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        offset = alignOffset(offset);
+        records[i].columnOffsets[c] = offset;
+        offset += records[i].numYears * sizeof(int);
+      }
+      offset = alignOffset(offset);
+      records[i].totalsOffset = offset;
+      offset += totalsBytes(records[i].numYears);
+    }
+
+    SnapshotHeader header = {};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.cityCount = static_cast<uint32_t>(count);
+    header.fileSize = offset;
+
+    ofstream file(fileName, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+      return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(records.data()), count * sizeof(SnapshotCity));
+    for (int i = 0; i < count; i++) {
+      file.write(cities[i]->getName().data(), records[i].nameLength);
+    }
+
+    const char padding[SNAPSHOT_ALIGNMENT] = {};
+    for (int i = 0; i < count; i++) {
+      const void *columns[SNAPSHOT_COLUMNS] = {cities[i]->years(),
+                                               cities[i]->daysBelow32(),
+                                               cities[i]->daysAbove90(),
+                                               cities[i]->averageTemperatures(),
+                                               cities[i]->averageMaxes(),
+                                               cities[i]->averageMins()};
+      for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(padding, records[i].columnOffsets[c] - position);
+        file.write(static_cast<const char *>(columns[c]), records[i].numYears * sizeof(int));
+      }
+      uint64_t position = static_cast<uint64_t>(file.tellp());
+      file.write(padding, records[i].totalsOffset - position);
+      for (int t = 0; t < SNAPSHOT_TOTALS; t++) {
+        file.write(reinterpret_cast<const char *>(cities[i]->runningTotals(t)),
+                   (records[i].numYears + 1) * sizeof(double));
+      }
+    }
+    file.close();
+    return !file.fail();
+  }
+
+  bool saveSnapshot(const string &fileName, const CityDataset &dataset) {
+    vector<const CityTemperatureData *> cities;
+    for (int i = 0; i < dataset.count(); i++) {
+      cities.push_back(&dataset[i]);
+    }
+    return saveSnapshot(fileName, cities.data(), dataset.count());
+  }
+
+  // Map the snapshot and wrap every city's columns and running totals
+  // where they lie, taking its summary from its SnapshotCity
+  // Every offset is checked against the size of the file first, so a
+  // truncated or foreign file is rejected rather than read past its end
+  CitySnapshot::CitySnapshot(const string &fileName) : _file(fileName) {
+    if (!_file.isOpen() || _file.size() < sizeof(SnapshotHeader)) {
+      return;
+    }
+    const uint64_t size = _file.size();
+    SnapshotHeader header;
+    memcpy(&header, _file.data(), sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SNAPSHOT_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER
+        || header.fileSize != size
+        || (size - sizeof(header)) / sizeof(SnapshotCity) < header.cityCount) {
+      return;
+    }
+
+    const char *base = _file.data();
+    _cities.reserve(header.cityCount);
+    for (uint32_t i = 0; i < header.cityCount; i++) {
+      SnapshotCity record;
+      memcpy(&record, base + sizeof(header) + i * sizeof(SnapshotCity), sizeof(record));
+      if (record.nameOffset > size || record.nameLength > size - record.nameOffset) {
+        return;
+      }
+      const uint64_t columnBytes = static_cast<uint64_t>(record.numYears) * sizeof(int);
+      for (uint64_t columnOffset : record.columnOffsets) {
+        if (columnOffset % SNAPSHOT_ALIGNMENT != 0 || columnOffset > size
+            || columnBytes > size - columnOffset) {
+          return;
+        }
+      }
+      if (record.totalsOffset % SNAPSHOT_ALIGNMENT != 0 || record.totalsOffset > size
+          || totalsBytes(record.numYears) > size - record.totalsOffset) {
+        return;
+      }
+
+      const CitySummary summary = {(record.layout & SNAPSHOT_CONSECUTIVE) != 0,
+                                   (record.layout & SNAPSHOT_ASCENDING) != 0,
+                                   record.temperatureTotal,
+                                   record.temperatureCount,
+                                   record.totalBelow32,
+                                   record.totalAbove90,
+                                   record.highestAverageMax,
+                                   record.lowestAverageMin};
+      const uint64_t *columns = record.columnOffsets;
+      _cities.emplace_back(
+          string(base + record.nameOffset, record.nameLength),
+          reinterpret_cast<const int *>(base + columns[0]),
+          reinterpret_cast<const int *>(base + columns[1]),
+          reinterpret_cast<const int *>(base + columns[2]),
+          reinterpret_cast<const float *>(base + columns[3]),
+          reinterpret_cast<const float *>(base + columns[4]),
+          reinterpret_cast<const float *>(base + columns[5]), static_cast<int>(record.numYears),
+          summary, reinterpret_cast<const double *>(base + record.totalsOffset));
+    }
+    _valid = true;
+  }
+
+  // Open a snapshot; nullptr if it is missing or not a valid snapshot
+  CitySnapshot *openSnapshot(const string &fileName) {
+    CitySnapshot *snapshot = new CitySnapshot(fileName);
+    if (!snapshot->isValid()) {
+      delete snapshot;
+      return nullptr;
+    }
+    return snapshot;
+  }
+
+  // Open *snapshotFile*, first building it from every city in *csvFile*
+  // (the slow path through readDataset()) if it is missing or invalid
+  CitySnapshot *loadCities(const string &snapshotFile, const string &csvFile) {
+    CitySnapshot *snapshot = openSnapshot(snapshotFile);
+    if (snapshot != nullptr) {
+      return snapshot;
+    }
+
+    CityDataset *dataset = readDataset(csvFile);
+    if (dataset == nullptr) {
+      return nullptr;
+    }
+    bool saved = saveSnapshot(snapshotFile, *dataset);
+    delete dataset;
+    return saved ? openSnapshot(snapshotFile) : nullptr;
+  }
+}  // namespace csi281
@@ -0,0 +1,122 @@
+//
+//  Snapshot.h
+//
+//  Saving parsed cities to a versioned binary snapshot, and loading them
+//  back by memory mapping the snapshot and using its columns in place.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef Snapshot_hpp
+#define Snapshot_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CityDataset.h"
+#include "CityTemperatureData.h"
+#include "MappedFile.h"
+#include "MemoryLeakDetector.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Layout of a snapshot file (all numbers in the byte order of the
+  // machine that wrote it, which the loader checks):
+  //   SnapshotHeader
+  //   SnapshotCity for every city
+  //   the bytes of every city's name
+  //   six columns per city (years, DX32, DX90, TAVG, TMAX, TMIN) and then
+  //   its running totals, each starting on a SNAPSHOT_ALIGNMENT byte boundary
+  // Each SnapshotCity also carries the city's summary, so loading scans
+  // none of the columns
+  const char SNAPSHOT_MAGIC[8] = {'C', 'S', 'I', '2', '8', '1', 'T', 'D'};
+  const uint32_t SNAPSHOT_VERSION = 2;
+  const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+  const uint64_t SNAPSHOT_ALIGNMENT = 64;
+  const int SNAPSHOT_COLUMNS = 6;
+  const int SNAPSHOT_TOTALS = CityTemperatureData::NUM_RUNNING_TOTALS;
+  // Bits of SnapshotCity::layout
+  const uint32_t SNAPSHOT_CONSECUTIVE = 1;  // CitySummary::consecutive
+  const uint32_t SNAPSHOT_ASCENDING = 2;    // CitySummary::ascending
+
+  struct SnapshotHeader {
+    char magic[8];        // SNAPSHOT_MAGIC
+    uint32_t version;     // SNAPSHOT_VERSION
+    uint32_t byteOrder;   // SNAPSHOT_BYTE_ORDER as written by the saving machine
+    uint32_t cityCount;   // number of SnapshotCity records after the header
+    uint32_t reserved;    // always 0
+    uint64_t fileSize;    // total size of the file, to detect truncation
+  };
+
+  struct SnapshotCity {
+    uint64_t nameOffset;                       // offset of the name's bytes
+    uint32_t nameLength;                       // length of the name in bytes
+    uint32_t numYears;                         // number of entries in each column
+    uint64_t columnOffsets[SNAPSHOT_COLUMNS];  // offset of each column
+    uint64_t totalsOffset;                     // offset of SNAPSHOT_TOTALS arrays of
+                                               // numYears + 1 running totals (doubles)
+    // the rest of CitySummary
+    uint32_t layout;             // SNAPSHOT_CONSECUTIVE and SNAPSHOT_ASCENDING bits
+    int32_t temperatureCount;
+    float temperatureTotal;
+    int32_t totalBelow32;
+    int32_t totalAbove90;
+    float highestAverageMax;
+    float lowestAverageMin;
+    uint32_t reserved;           // always 0
+  };
+
+  // Write *count* cities to a snapshot file; false if it could not be written
+  bool saveSnapshot(const string &fileName, const CityTemperatureData *const cities[], int count);
+  bool saveSnapshot(const string &fileName, const CityDataset &dataset);
+
+  // The cities of a snapshot file, whose columns and running totals are
+  // used straight out of the memory mapping; nothing is parsed, scanned
+  // or copied
+  class CitySnapshot {
+  public:
+    explicit CitySnapshot(const string &fileName);
+    CitySnapshot(const CitySnapshot &) = delete;
+    CitySnapshot &operator=(const CitySnapshot &) = delete;
+
+    // Was the file a complete snapshot of this version and byte order
+    bool isValid() const { return _valid; }
+    int count() const { return static_cast<int>(_cities.size()); }
+    const CityTemperatureData &operator[](int index) const { return _cities[index]; }
+
+  private:
+    MappedFile _file;                        // the snapshot, mapped for our whole lifetime
+    vector<CityTemperatureData> _cities;     // views into _file
+    bool _valid = false;
+  };
+
+  // Open a snapshot; nullptr if it is missing or not a valid snapshot
+  CitySnapshot *openSnapshot(const string &fileName);
+
+  // Open *snapshotFile*, first building it from every city in *csvFile*
+  // (the slow path through readDataset()) if it is missing or invalid
+  CitySnapshot *loadCities(const string &snapshotFile, const string &csvFile);
+}  // namespace csi281
+
+#endif /* Snapshot_hpp */
@@ -0,0 +1,246 @@
+//
+//  columns.h
+//
+//  Reduction kernels (sum, mean, minimum, maximum) over one contiguous
+//  column of ints or floats, vectorized with SSE2 where it is available.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef columns_hpp
+#define columns_hpp
+
+#include <algorithm>  // for min(), max()
+#include <cassert>
+#include <cmath>      // for isnan()
+#include <limits>
+
+#include "MemoryLeakDetector.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define CSI281_COLUMNS_SSE2
+#  include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace csi281 {
+
+  // A missing float reading (a blank cell) is stored as NaN, and the float
+  // kernels below skip it rather than letting it poison the result
+
+  // Sum of the first *count* values
+  // Floats are added in four interleaved lanes, so the result can differ
+  // from a strictly left to right sum in the last bits
+  inline float columnSum(const float values[], const int count) {
+    int i = 0;
+#ifdef CSI281_COLUMNS_SSE2
+    __m128 lanes0 = _mm_setzero_ps();
+    __m128 lanes1 = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+      // a lane only compares ordered with itself if it isn't NaN, so the
+      // mask zeroes the missing values
+      __m128 next0 = _mm_loadu_ps(values + i);
+      __m128 next1 = _mm_loadu_ps(values + i + 4);
+      lanes0 = _mm_add_ps(lanes0, _mm_and_ps(next0, _mm_cmpord_ps(next0, next0)));
+      lanes1 = _mm_add_ps(lanes1, _mm_and_ps(next1, _mm_cmpord_ps(next1, next1)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(lanes0, lanes1));
+    float total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    float total = 0;
+#endif
+    for (; i < count; i++) {
+      if (!isnan(values[i])) {
+        total += values[i];
+      }
+    }
+    return total;
+  }
+
+  inline int columnSum(const int values[], const int count) {
+    int i = 0;
+#ifdef CSI281_COLUMNS_SSE2
+    __m128i lanes0 = _mm_setzero_si128();
+    __m128i lanes1 = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+      lanes0 = _mm_add_epi32(lanes0, _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)));
+      lanes1 = _mm_add_epi32(lanes1,
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i + 4)));
+    }
+    int lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _mm_add_epi32(lanes0, lanes1));
+    int total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    int total = 0;
+#endif
+    for (; i < count; i++) {
+      total += values[i];
+    }
+    return total;
+  }
+
+  // How many of the first *count* values are not missing
+  inline int columnCount(const float values[], const int count) {
+    int i = 0;
+    int present = 0;
+#ifdef CSI281_COLUMNS_SSE2
+    __m128i lanes = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+      // a lane that isn't NaN compares to all ones, which is -1 as an int
+      __m128 next = _mm_loadu_ps(values + i);
+      lanes = _mm_sub_epi32(lanes, _mm_castps_si128(_mm_cmpord_ps(next, next)));
+    }
+    int counts[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(counts), lanes);
+    present = counts[0] + counts[1] + counts[2] + counts[3];
+#endif
+    for (; i < count; i++) {
+      present += !isnan(values[i]);
+    }
+    return present;
+  }
+
+  // Mean of the first *count* values (of those not missing for floats)
+  inline float columnMean(const float values[], const int count) {
+    return columnSum(values, count) / columnCount(values, count);
+  }
+
+  inline float columnMean(const int values[], const int count) {
+    return static_cast<float>(columnSum(values, count)) / count;
+  }
+
+  // The position of the first value that is not missing, or *count*
+  inline int firstPresent(const float values[], const int count) {
+    int i = 0;
+    while (i < count && isnan(values[i])) {
+      i++;
+    }
+    return i;
+  }
+
+  // Smallest of the first *count* values that are not missing, or NaN if
+  // they all are
+  inline float columnMin(const float values[], const int count) {
+    int i = firstPresent(values, count);
+    if (i == count) {
+      return numeric_limits<float>::quiet_NaN();
+    }
+    float result = values[i++];
+#ifdef CSI281_COLUMNS_SSE2
+    if (count - i >= 4) {
+      // _mm_min_ps gives its second operand if either one is NaN, so
+      // keeping the running minimums second passes over missing values
+      __m128 lanes = _mm_set1_ps(result);
+      for (; i + 4 <= count; i += 4) {
+        lanes = _mm_min_ps(_mm_loadu_ps(values + i), lanes);
+      }
+      float smallest[4];
+      _mm_storeu_ps(smallest, lanes);
+      result = min(min(smallest[0], smallest[1]), min(smallest[2], smallest[3]));
+    }
+#endif
+    // min() keeps its first argument when the second is NaN
+    for (; i < count; i++) {
+      result = min(result, values[i]);
+    }
+    return result;
+  }
+
+  // Smallest of the first *count* values; there must be at least one
+  inline int columnMin(const int values[], const int count) {
+    assert(count > 0);
+    int i = 0;
+    int result = values[0];
+#ifdef CSI281_COLUMNS_SSE2
+    if (count >= 4) {
+      // SSE2 has no 32 bit integer min, so blend on a comparison mask
+      __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+      for (i = 4; i + 4 <= count; i += 4) {
+        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        __m128i nextIsSmaller = _mm_cmplt_epi32(next, lanes);
+        lanes = _mm_or_si128(_mm_and_si128(nextIsSmaller, next),
+                             _mm_andnot_si128(nextIsSmaller, lanes));
+      }
+      int smallest[4];
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(smallest), lanes);
+      result = min(min(smallest[0], smallest[1]), min(smallest[2], smallest[3]));
+    }
+#endif
+    for (; i < count; i++) {
+      result = min(result, values[i]);
+    }
+    return result;
+  }
+
+  // Largest of the first *count* values that are not missing, or NaN if
+  // they all are
+  inline float columnMax(const float values[], const int count) {
+    int i = firstPresent(values, count);
+    if (i == count) {
+      return numeric_limits<float>::quiet_NaN();
+    }
+    float result = values[i++];
+#ifdef CSI281_COLUMNS_SSE2
+    if (count - i >= 4) {
+      __m128 lanes = _mm_set1_ps(result);
+      for (; i + 4 <= count; i += 4) {
+        lanes = _mm_max_ps(_mm_loadu_ps(values + i), lanes);
+      }
+      float largest[4];
+      _mm_storeu_ps(largest, lanes);
+      result = max(max(largest[0], largest[1]), max(largest[2], largest[3]));
+    }
+#endif
+    for (; i < count; i++) {
+      result = max(result, values[i]);
+    }
+    return result;
+  }
+
+  // Largest of the first *count* values; there must be at least one
+  inline int columnMax(const int values[], const int count) {
+    assert(count > 0);
+    int i = 0;
+    int result = values[0];
+#ifdef CSI281_COLUMNS_SSE2
+    if (count >= 4) {
+      __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+      for (i = 4; i + 4 <= count; i += 4) {
+        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        __m128i nextIsLarger = _mm_cmpgt_epi32(next, lanes);
+        lanes = _mm_or_si128(_mm_and_si128(nextIsLarger, next),
+                             _mm_andnot_si128(nextIsLarger, lanes));
+      }
+      int largest[4];
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(largest), lanes);
+      result = max(max(largest[0], largest[1]), max(largest[2], largest[3]));
+    }
+#endif
+    for (; i < count; i++) {
+      result = max(result, values[i]);
+    }
+    return result;
+  }
+}  // namespace csi281
+
+#endif /* columns_hpp */
@@ -27,10 +27,19 @@
 
 #include "csv.h"
 
-#include <algorithm>  // for remove_if()
+#include <algorithm>  // for remove_if(), count()
+#include <charconv>   // for from_chars()
+#include <cstring>    // for memchr()
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>  // for move()
+#include <vector>
+
+#include "MappedFile.h"
 
 using namespace std;
 
@@ -44,20 +53,24 @@ namespace csi281 {
 
   // Read from a input string stream we hit the next comma, or the end
   // and try to convert it into the float we seek.
+  // A missing or malformed cell gives NaN rather than throwing
   float readFloatCell(istringstream &iss) {
     string holder;
     getline(iss, holder, ',');
-    clean(holder);
-    return stof(holder);
+    float value;
+    parseFloatCell(holder, value);
+    return value;
   }
 
   // Read from a input string stream we hit the next comma, or the end
   // and try to convert it into the int we seek.
+  // A missing or malformed cell gives 0 rather than throwing
   int readIntCell(istringstream &iss) {
     string holder;
     getline(iss, holder, ',');
-    clean(holder);
-    return stoi(holder);
+    int value;
+    parseIntCell(holder, value);
+    return value;
   }
 
   // Read from a input string stream we hit the next comma, or the end
@@ -68,68 +81,386 @@ namespace csi281 {
     return holder;
   }
 
+  // Is *c* one of the characters clean() would strip
+  static bool isPadding(char c) {
+    return c == '\"' || c == '\'' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  }
+
+  // The string_view equivalent of clean(); only the surrounding
+  // quotes and whitespace are removed, nothing is copied
+  static string_view trimCell(string_view cell) {
+    while (!cell.empty() && isPadding(cell.front())) {
+      cell.remove_prefix(1);
+    }
+    while (!cell.empty() && isPadding(cell.back())) {
+      cell.remove_suffix(1);
+    }
+    return cell;
+  }
+
+  // Turn *cell* into a number of type T with from_chars(), which neither
+  // allocates, throws nor looks at the locale
+  // *value* is left alone unless the status is CellStatus::OK
+  template <typename T> static CellStatus parseNumberCell(string_view cell, T &value) {
+    cell = trimCell(cell);
+    if (cell.empty()) {
+      return CellStatus::MISSING;
+    }
+    // from_chars() does not accept a leading plus sign
+    if (cell.size() > 1 && cell[0] == '+' && cell[1] != '-') {
+      cell.remove_prefix(1);
+    }
+
+    T parsed;
+    auto [end, error] = from_chars(cell.data(), cell.data() + cell.size(), parsed);
+    if (error == errc::result_out_of_range) {
+      return CellStatus::OUT_OF_RANGE;
+    }
+    if (error != errc() || end != cell.data() + cell.size()) {
+      return CellStatus::INVALID;
+    }
+    value = parsed;
+    return CellStatus::OK;
+  }
+
+  // Turn *cell* into an int; *value* is 0 unless the status is CellStatus::OK
+  CellStatus parseIntCell(string_view cell, int &value) {
+    value = 0;
+    return parseNumberCell(cell, value);
+  }
+
+  // Turn *cell* into a float; *value* is NaN unless the status is CellStatus::OK
+  CellStatus parseFloatCell(string_view cell, float &value) {
+    value = numeric_limits<float>::quiet_NaN();
+    return parseNumberCell(cell, value);
+  }
+
+  // Split the next line off the front of *csv*, without its line ending
+  string_view nextLine(string_view &csv) {
+    const char *newline = static_cast<const char *>(memchr(csv.data(), '\n', csv.size()));
+    size_t length = newline == nullptr ? csv.size() : static_cast<size_t>(newline - csv.data());
+    string_view line = csv.substr(0, length);
+    csv.remove_prefix(min(length + 1, csv.size()));
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    return line;
+  }
+
+  // Split the next cell off the front of *line*, up to the next comma or the end
+  string_view nextCell(string_view &line) {
+    size_t comma = line.find(',');
+    string_view cell = line.substr(0, comma);
+    line.remove_prefix(comma == string_view::npos ? line.size() : comma + 1);
+    return cell;
+  }
+
+  // Turn a single line of the CSV into *cy*, reading straight out of
+  // the line's bytes without allocating
+  // Every field is filled in even when some are bad; the status returned
+  // is that of the first field that could not be read
+  CellStatus parseLine(string_view line, CityYear &cy) {
+    // Skip the first two columns (station and name)
+    nextCell(line);
+    nextCell(line);
+
+    CellStatus statuses[6] = {parseIntCell(nextCell(line), cy.year),
+                              parseIntCell(nextCell(line), cy.numDaysBelow32),
+                              parseIntCell(nextCell(line), cy.numDaysAbove90),
+                              parseFloatCell(nextCell(line), cy.averageTemperature),
+                              parseFloatCell(nextCell(line), cy.averageMax),
+                              parseFloatCell(nextCell(line), cy.averageMin)};
+    for (CellStatus status : statuses) {
+      if (status != CellStatus::OK) {
+        return status;
+      }
+    }
+    return CellStatus::OK;
+  }
+
+  // Turn a single line of the CSV into a CityYear, reading straight
+  // out of the line's bytes without allocating
+  CityYear parseLine(string_view line) {
+    CityYear cy;
+    parseLine(line, cy);
+    return cy;
+  }
+
   // Read a single line from a file stream and turn it into a CityYear
   // You'll want to use the standard library function getline()
   // and the readCell() functions above
   // You'll also want to construct a CityYear from what you have read from the file
   CityYear readLine(ifstream &file) {
-      string line;
-      getline(file, line);
-      istringstream iss(line);
+    CityYear cy;
+    readLine(file, cy);
+    return cy;
+  }
 
-      // Skip the first two columns (station and name)
-      readStringCell(iss);
-      readStringCell(iss);
+  // Read a single line from a file stream into *cy*, reporting the
+  // first field that could not be read instead of throwing
+  CellStatus readLine(ifstream &file, CityYear &cy) {
+    string line;
+    getline(file, line);
+    return parseLine(line, cy);
+  }
 
-      CityYear cy;
-      cy.year = readIntCell(iss);
-      cy.numDaysBelow32 = readIntCell(iss);
-      cy.numDaysAbove90 = readIntCell(iss);
-      cy.averageTemperature = readFloatCell(iss);
-      cy.averageMax = readFloatCell(iss);
-      cy.averageMin = readFloatCell(iss);
+  // Parse the lines between startLine and endLine (inclusive) of *csv*,
+  // handing each CityYear to *store(index, cy)* with index counting from 0
+  template <typename Store>
+  static int parseLines(string_view csv, int startLine, int endLine, Store store) {
+    for (int i = 0; i < startLine && !csv.empty(); i++) {
+      nextLine(csv);
+    }
 
-      return cy;
+    int numYears = 0;
+    for (int i = startLine; i <= endLine && !csv.empty(); i++) {
+      store(numYears++, parseLine(nextLine(csv)));
+    }
+    return numYears;
+  }
+
+  // Parse the lines between startLine and endLine (inclusive) of the CSV
+  // held in *csv* into *out*, which must have room for every line
+  // Line 0 is the header; returns the number of CityYears read
+  int parseCityYears(string_view csv, int startLine, int endLine, CityYear out[]) {
+    return parseLines(csv, startLine, endLine, [&](int i, const CityYear &cy) { out[i] = cy; });
+  }
+
+  // Chunks smaller than this are not worth a thread of their own
+  static const size_t MIN_CHUNK_BYTES = 1 << 16;
+
+  // How many threads to use when asked for *numThreads* (0 means one per core)
+  static int resolveThreads(int numThreads) {
+    if (numThreads <= 0) {
+      numThreads = static_cast<int>(thread::hardware_concurrency());
+    }
+    return max(numThreads, 1);
+  }
+
+  // Split *csv* into at most *numChunks* pieces of roughly equal size,
+  // every piece but the last ending just after a newline
+  static vector<string_view> splitAtLines(string_view csv, int numChunks) {
+    size_t chunkBytes = max(csv.size() / max(numChunks, 1) + 1, MIN_CHUNK_BYTES);
+    vector<string_view> chunks;
+    while (!csv.empty()) {
+      // end the chunk at the first newline at or after its target size
+      size_t target = min(chunkBytes, csv.size()) - 1;
+      const void *newline = memchr(csv.data() + target, '\n', csv.size() - target);
+      size_t length = newline == nullptr
+                          ? csv.size()
+                          : static_cast<size_t>(static_cast<const char *>(newline) - csv.data()) + 1;
+      chunks.push_back(csv.substr(0, length));
+      csv.remove_prefix(length);
+    }
+    return chunks;
+  }
+
+  // How many lines nextLine() would split *chunk* into
+  static int countLines(string_view chunk) {
+    if (chunk.empty()) {
+      return 0;
+    }
+    int lines = static_cast<int>(count(chunk.begin(), chunk.end(), '\n'));
+    return chunk.back() == '\n' ? lines : lines + 1;
+  }
+
+  // How many of the lines nextLine() would split *chunk* into are not empty
+  static int countRows(string_view chunk) {
+    int rows = 0;
+    while (!chunk.empty()) {
+      if (!nextLine(chunk).empty()) {
+        rows++;
+      }
+    }
+    return rows;
+  }
+
+  // Run *work(i)* for every i in [0, count), each on its own thread, and
+  // wait for all of them; the calling thread does the first piece of work
+  template <typename Work> static void runOnThreads(int count, Work work) {
+    vector<thread> workers;
+    workers.reserve(count);
+    for (int i = 1; i < count; i++) {
+      workers.emplace_back(work, i);
+    }
+    work(0);
+    for (thread &worker : workers) {
+      worker.join();
+    }
+  }
+
+  // Split *csv* at newlines into one chunk per thread and count what is in
+  // every chunk with *counter* in parallel; *firsts* receives the running
+  // count at the start of each chunk, followed by the total
+  template <typename Counter>
+  static vector<string_view> splitAndCount(string_view csv, int numThreads, vector<int> &firsts,
+                                           Counter counter) {
+    vector<string_view> chunks = splitAtLines(csv, numThreads);
+    firsts.assign(chunks.size() + 1, 0);
+    runOnThreads(static_cast<int>(chunks.size()),
+                 [&](int i) { firsts[i + 1] = counter(chunks[i]); });
+    for (size_t i = 0; i < chunks.size(); i++) {
+      firsts[i + 1] += firsts[i];
+    }
+    return chunks;
+  }
+
+  // Parallel version of parseLines(), giving exactly the same result
+  // The CSV is split at newlines into one chunk per thread; after the lines
+  // of every chunk are counted, each thread parses its own lines and stores
+  // them at their final index, so no merging step is needed
+  // Worker threads never allocate
+  template <typename Store>
+  static int parseLines(string_view csv, int startLine, int endLine, Store store, int numThreads) {
+    vector<int> firstLines;
+    vector<string_view> chunks
+        = splitAndCount(csv, resolveThreads(numThreads), firstLines, countLines);
+    int lastLine = min(endLine, firstLines.back() - 1);
+    if (lastLine < startLine) {
+      return 0;
+    }
+
+    runOnThreads(static_cast<int>(chunks.size()), [&](int i) {
+      string_view chunk = chunks[i];
+      for (int line = firstLines[i]; line < firstLines[i + 1] && line <= lastLine; line++) {
+        string_view text = nextLine(chunk);
+        if (line >= startLine) {
+          store(line - startLine, parseLine(text));
+        }
+      }
+    });
+    return lastLine - startLine + 1;
+  }
+
+  // Same as above, but the CSV is split at line boundaries into chunks
+  // that are parsed on *numThreads* threads (0 means one per core)
+  int parseCityYears(string_view csv, int startLine, int endLine, CityYear out[], int numThreads) {
+    return parseLines(
+        csv, startLine, endLine, [&](int i, const CityYear &cy) { out[i] = cy; }, numThreads);
+  }
+
+  // Parse the lines between startLine and endLine (inclusive) straight into
+  // *out*, whose columns must have room for every line
+  int parseCityYears(string_view csv, int startLine, int endLine, const CityColumns &out,
+                     int numThreads) {
+    auto store = [&](int i, const CityYear &cy) { out.set(i, cy); };
+    return numThreads == 1 ? parseLines(csv, startLine, endLine, store)
+                           : parseLines(csv, startLine, endLine, store, numThreads);
   }
 
   // Read city by looking at the specified lines in the CSV
-  // You'll need to open an ifstream to fileName
-  // You'll need to read CityYears from the file using readLine() until there
-  // is nothing left to read
-  // The ifstream method good() may be useful
-  // Make sure to just read between startLine and endLine (inclusive of endLine)
+  // The file is memory mapped and tokenized in place, so no
+  // strings are created for any of the cells
   // Construct a CityTemperatureData and return it
-  // create an array of CityYear instances to pass to the CityTemperatureData constructor
-  // when the CityTemperatureData is created, it will take ownership of the array
+  // The lines are parsed straight into the columns that the
+  // CityTemperatureData then takes ownership of, so nothing is copied
   CityTemperatureData* readCity(string cityName, string fileName, int startLine, int endLine) {
-    ifstream file(fileName);
-    if (file.is_open())
-    {
-      string line;
-      // Skip header line
-      getline(file, line);
-
-      for (int i = 0; i < startLine - 1; i++)
-      {
-          getline(file, line);
-      }
+    return readCity(cityName, fileName, startLine, endLine, 1);
+  }
 
-      int numYears = endLine - startLine + 1;
-      CityYear* cityYears = new CityYear[numYears];
+  // readCity() parsing with *numThreads* threads (0 means one per core)
+  CityTemperatureData* readCity(string cityName, string fileName, int startLine, int endLine,
+                                int numThreads) {
+    MappedFile file(fileName);
+    if (!file.isOpen()) {
+      cout << "Error opening file " << fileName << " for reading." << endl;
+      return nullptr;
+    }
 
-      for (int i = 0; i < numYears; i++)
-      {
-          cityYears[i] = readLine(file);
-      }
+    int capacity = max(endLine - startLine + 1, 0);
+    int* intColumns = new int[3 * capacity];
+    float* floatColumns = new float[3 * capacity];
+    CityColumns columns(intColumns, floatColumns, capacity);
+    int numYears = parseCityYears(file.view(), startLine, endLine, columns, numThreads);
+    return new CityTemperatureData(cityName, intColumns, floatColumns, capacity, numYears);
+  }
 
-      file.close();
+  // Assigns rows to stations by their STATION column, numbering the
+  // stations in order of first appearance
+  class StationGrouper {
+  public:
+    explicit StationGrouper(const char *fileStart) : _fileStart(fileStart) {}
 
-      return new CityTemperatureData(cityName, cityYears, numYears);
+    // Note the station of the next row, parsed from *line*, which must
+    // point into the file
+    void add(string_view line) {
+      string_view cells = line;
+      string_view station = trimCell(nextCell(cells));
+      auto [slot, isNew] = _stationIndex.try_emplace(station, static_cast<int>(_stations.size()));
+      if (isNew) {
+        string_view name = trimCell(nextCell(cells));
+        size_t offset = static_cast<size_t>(line.data() - _fileStart);
+        _stations.push_back({string(station), string(name), offset, 0});
+      }
+      _stations[slot->second].rowCount++;
+      _rowStations.push_back(slot->second);
     }
-    else
-    {
+
+    // Build the dataset out of *rows*, which must match the added lines
+    CityDataset *finish(CityRows &rows) {
+      return new CityDataset(move(_stations), move(rows), _rowStations);
+    }
+
+  private:
+    const char *_fileStart;
+    vector<StationEntry> _stations;
+    vector<int> _rowStations;  // station of each row added
+    // the keys point into the file, which outlives the grouper
+    unordered_map<string_view, int> _stationIndex;
+  };
+
+  // Read every city in the CSV in a single pass, grouping the rows by
+  // their STATION column; each city is named after its NAME column
+  // Rows of a station do not need to be next to each other, but the
+  // offset recorded for a station is always that of its first row
+  // Rows are parsed straight into the dataset's shared arena, which the
+  // cities are views of
+  // With more than one thread, the rows are parsed in parallel first and
+  // then assigned to stations in file order, which gives the same dataset
+  CityDataset* readDataset(string fileName, int numThreads) {
+    MappedFile file(fileName);
+    if (!file.isOpen()) {
       cout << "Error opening file " << fileName << " for reading." << endl;
       return nullptr;
     }
+
+    string_view csv = file.view();
+    // Skip header line
+    nextLine(csv);
+
+    StationGrouper grouper(file.data());
+    CityRows rows;
+    if (numThreads == 1) {
+      while (!csv.empty()) {
+        string_view line = nextLine(csv);
+        if (!line.empty()) {
+          grouper.add(line);
+          rows.push_back(parseLine(line));
+        }
+      }
+      return grouper.finish(rows);
+    }
+
+    vector<int> firstRows;
+    vector<string_view> chunks
+        = splitAndCount(csv, resolveThreads(numThreads), firstRows, countRows);
+    rows.resize(firstRows.back());
+    vector<string_view> lines(firstRows.back());
+    CityColumns columns = rows.columns();
+    runOnThreads(static_cast<int>(chunks.size()), [&](int i) {
+      string_view chunk = chunks[i];
+      int row = firstRows[i];
+      while (!chunk.empty()) {
+        string_view line = nextLine(chunk);
+        if (!line.empty()) {
+          lines[row] = line;
+          columns.set(row++, parseLine(line));
+        }
+      }
+    });
+    for (string_view line : lines) {
+      grouper.add(line);
+    }
+    return grouper.finish(rows);
   }
-}  // namespace csi281
\ No newline at end of file
+}  // namespace csi281
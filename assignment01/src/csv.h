@@ -31,7 +31,9 @@
 
 #include <fstream>
 #include <string>
+#include <string_view>
 
+#include "CityDataset.h"
 #include "CityTemperatureData.h"
 #include "MemoryLeakDetector.h"
 
@@ -39,6 +41,14 @@ using namespace std;
 
 namespace csi281 {
 
+  // Outcome of turning a cell of the CSV into a number
+  enum class CellStatus {
+    OK,            // the cell held a number
+    MISSING,       // the cell was blank (or there was no such cell)
+    INVALID,       // the cell held something other than a number
+    OUT_OF_RANGE   // the cell held a number too large for the type
+  };
+
   // Remove extraneous characters from string so it can
   // be converted into a number
   void clean(string &str);
@@ -49,11 +59,50 @@ namespace csi281 {
   int readIntCell(istringstream &iss);
   string readStringCell(istringstream &iss);
 
+  // Turn a cell into a number without allocating or throwing; quotes
+  // and whitespace around the number are skipped in place
+  CellStatus parseIntCell(string_view cell, int &value);
+  CellStatus parseFloatCell(string_view cell, float &value);
+
   // Read a single line from a file stream and turn it into a CityYear
   CityYear readLine(ifstream &file);
+  CellStatus readLine(ifstream &file, CityYear &cy);
+
+  // Split the next line off the front of *csv*, without its line ending
+  string_view nextLine(string_view &csv);
+
+  // Split the next cell off the front of *line*, up to the next comma or the end
+  string_view nextCell(string_view &line);
+
+  // Turn a single line of the CSV into a CityYear, reading straight
+  // out of the line's bytes without allocating
+  // Missing or bad ints read as 0 and floats as NaN; the status is that
+  // of the first field that could not be read
+  CityYear parseLine(string_view line);
+  CellStatus parseLine(string_view line, CityYear &cy);
+
+  // Parse the lines between startLine and endLine (inclusive) of the CSV
+  // held in *csv* into *out*, which must have room for every line
+  // Line 0 is the header; returns the number of CityYears read
+  int parseCityYears(string_view csv, int startLine, int endLine, CityYear out[]);
+
+  // Same as above, but the CSV is split at line boundaries into chunks
+  // that are parsed on *numThreads* threads (0 means one per core)
+  int parseCityYears(string_view csv, int startLine, int endLine, CityYear out[], int numThreads);
+
+  // Same as above, but the lines are parsed straight into the columns of *out*
+  int parseCityYears(string_view csv, int startLine, int endLine, const CityColumns &out,
+                     int numThreads = 1);
 
   // Read city by looking at the specified lines in the CSV
   CityTemperatureData* readCity(string cityName, string fileName, int startLine, int endLine);
+  CityTemperatureData* readCity(string cityName, string fileName, int startLine, int endLine,
+                                int numThreads);
+
+  // Read every city in the CSV in a single pass, grouping the rows by
+  // their STATION column; each city is named after its NAME column
+  // Rows are parsed on *numThreads* threads (0 means one per core)
+  CityDataset* readDataset(string fileName, int numThreads = 1);
 }  // namespace csi281
 
 #endif /* csv_hpp */
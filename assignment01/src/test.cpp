@@ -32,7 +32,12 @@
 #define TEST_CASE(name, tags) DOCTEST_TEST_CASE(tags " " name)
 using doctest::Approx;
 
+#include <cstdio>  // for remove()
+#include <limits>
+
 #include "CityTemperatureData.h"
+#include "Snapshot.h"
+#include "columns.h"
 #include "csv.h"
 
 using namespace std;
@@ -56,6 +61,21 @@ TEST_CASE("New York Test Data", "[New York]") {
     CHECK(nyc->getAllTimeAverage() == Approx(55.25294118f).epsilon(0.01));
     CHECK(nyc->getTotalDaysBelow32() == 967);
     CHECK(nyc->getTotalDaysAbove90() == 891);
+    CHECK(nyc->getHighestAverageMax() == 65.5f);
+    CHECK(nyc->getLowestAverageMin() == 45.3f);
+  }
+
+  SECTION("Range queries") {
+    CHECK(nyc->indexOf(1968) == 0);
+    CHECK(nyc->indexOf(2018) == 50);
+    CHECK(nyc->indexOf(2019) == -1);
+    CHECK(nyc->getAverageTemperature(1980, 1989) == Approx(55.08f));
+    CHECK(nyc->getDaysAbove90(1980, 1989) == 195);
+    CHECK(nyc->getDaysBelow32(2010, 3000) == 157);
+    CHECK(nyc->getDaysBelow32(1900, 3000) == 967);
+    CHECK(nyc->getDaysBelow32(2019, 2030) == 0);
+    CHECK(nyc->getAverageMax(2018, 2018) == Approx(62.6f));
+    CHECK_THROWS(nyc->getAverageMin(1900, 1950));
   }
 
   delete nyc;
@@ -83,3 +103,428 @@ TEST_CASE("Burlington Test Data", "[Burlington]") {
 
   delete burlington;
 }
+
+TEST_CASE("Parsing In Place", "[Parsing]") {
+  SECTION("Single line") {
+    CityYear cy = parseLine(
+        "\"USW00094728\",\"NY CITY CENTRAL PARK\",\"1970\",\"29\",\"22\",\"54.2\",\"61.7\","
+        "\"46.8\"\r");
+    CHECK(cy.year == 1970);
+    CHECK(cy.numDaysBelow32 == 29);
+    CHECK(cy.numDaysAbove90 == 22);
+    CHECK(cy.averageTemperature == 54.2f);
+    CHECK(cy.averageMax == 61.7f);
+    CHECK(cy.averageMin == 46.8f);
+  }
+
+  SECTION("Line range") {
+    string_view csv
+        = "STATION,NAME,DATE,DX32,DX90,TAVG,TMAX,TMIN\n"
+          "A,X,2001,1,2,3.5,4.5,5.5\n"
+          "A,X,2002,6,7,8.5,9.5,10.5\n"
+          "B,Y,2001,11,12,13.5,14.5,15.5";
+    CityYear years[2];
+    REQUIRE(parseCityYears(csv, 2, 3, years) == 2);
+    CHECK(years[0].year == 2002);
+    CHECK(years[1].numDaysAbove90 == 12);
+    CHECK(years[1].averageMin == 15.5f);
+  }
+}
+
+TEST_CASE("Single Pass Dataset", "[Dataset]") {
+  CityDataset* dataset = readDataset("tempdata.csv");
+
+  REQUIRE(dataset != nullptr);
+  REQUIRE(dataset->count() == 2);
+
+  SECTION("Station index") {
+    CHECK(dataset->getStation(0).station == "USW00094728");
+    CHECK(dataset->getStation(0).name == "NY CITY CENTRAL PARK");
+    CHECK(dataset->getStation(0).rowCount == 51);
+    CHECK(dataset->getStation(1).station == "USW00014742");
+    CHECK(dataset->getStation(1).offset == 3864);
+    CHECK(dataset->getStation(1).rowCount == 51);
+    CHECK(dataset->find("USW00000000") == nullptr);
+  }
+
+  SECTION("Same data as readCity()") {
+    CityTemperatureData* burlington = dataset->find("USW00014742");
+    REQUIRE(burlington != nullptr);
+    CHECK(burlington->getName() == "BURLINGTON INTERNATIONAL AIRPORT");
+    CHECK(burlington->count() == 51);
+    CHECK((*burlington)[1978].numDaysBelow32 == 87);
+    CHECK(burlington->getTotalDaysBelow32() == 3242);
+    CHECK((*dataset)[0].getTotalDaysAbove90() == 891);
+  }
+
+  SECTION("Cities share one arena") {
+    CHECK((*dataset)[1].years() == (*dataset)[0].years() + 51);
+    CHECK((*dataset)[1].averageMins() == (*dataset)[0].averageMins() + 51);
+    // so do their running totals, 52 entries per column per city
+    const int numTotals = CityTemperatureData::NUM_RUNNING_TOTALS;
+    CHECK((*dataset)[0].runningTotals(1) == (*dataset)[0].runningTotals(0) + 52);
+    CHECK((*dataset)[1].runningTotals(0) == (*dataset)[0].runningTotals(0) + numTotals * 52);
+    CHECK((*dataset)[1].getDaysBelow32((*dataset)[1].getFirstYear(), 2018) == 3242);
+
+    // appending copies a city's totals out rather than spilling into the next city's
+    (*dataset)[0].append({2019, 1, 2, 50.0f, 60.0f, 40.0f});
+    CHECK((*dataset)[0].getDaysBelow32(2019, 2019) == 1);
+    CHECK((*dataset)[1].getDaysBelow32((*dataset)[1].getFirstYear(), 2018) == 3242);
+  }
+
+  delete dataset;
+}
+
+TEST_CASE("Column Kernels", "[Columns]") {
+  int ints[11] = {5, -3, 8, 12, 0, 7, -9, 4, 4, 21, 1};
+  float floats[11] = {1.5f, 2.5f, -4.0f, 8.0f, 0.5f, 3.0f, 9.5f, -1.0f, 2.0f, 6.0f, 0.25f};
+
+  SECTION("Sums and means") {
+    CHECK(columnSum(ints, 11) == 50);
+    CHECK(columnSum(ints, 3) == 10);
+    CHECK(columnSum(floats, 11) == Approx(28.25f));
+    CHECK(columnMean(floats, 4) == Approx(2.0f));
+    CHECK(columnMean(ints, 10) == Approx(4.9f));
+  }
+
+  SECTION("Minimums and maximums") {
+    CHECK(columnMin(ints, 11) == -9);
+    CHECK(columnMax(ints, 11) == 21);
+    CHECK(columnMax(ints, 2) == 5);
+    CHECK(columnMin(floats, 11) == -4.0f);
+    CHECK(columnMax(floats, 11) == 9.5f);
+    CHECK(columnMin(floats, 1) == 1.5f);
+  }
+
+  SECTION("Missing values") {
+    const float nan = numeric_limits<float>::quiet_NaN();
+    float gappy[11] = {nan, 2.5f, -4.0f, 8.0f, nan, 3.0f, 9.5f, -1.0f, nan, 6.0f, 0.25f};
+    CHECK(columnSum(gappy, 11) == Approx(24.25f));
+    CHECK(columnCount(gappy, 11) == 8);
+    CHECK(columnMean(gappy, 4) == Approx(6.5f / 3));
+    CHECK(columnMin(gappy, 11) == -4.0f);
+    CHECK(columnMax(gappy, 11) == 9.5f);
+    CHECK(columnMax(gappy, 1) != columnMax(gappy, 1));  // NaN, nothing to compare
+  }
+}
+
+TEST_CASE("Years With Gaps", "[Gaps]") {
+  CityYear ascending[4] = {{1990, 10, 1, 50.0f, 60.0f, 40.0f},
+                           {1992, 20, 2, 52.0f, 62.0f, 42.0f},
+                           {1995, 30, 3, 54.0f, 64.0f, 44.0f},
+                           {1996, 40, 4, 56.0f, 66.0f, 46.0f}};
+  CityYear unordered[3] = {{2001, 1, 5, 40.0f, 50.0f, 30.0f},
+                           {1999, 2, 6, 42.0f, 52.0f, 32.0f},
+                           {2000, 3, 7, 44.0f, 54.0f, 34.0f}};
+
+  SECTION("Ascending years") {
+    CityTemperatureData city("Gappy", ascending, 4);
+    CHECK(city[1995].numDaysBelow32 == 30);
+    CHECK(city.indexOf(1991) == -1);
+    CHECK_THROWS(city[1993]);
+    CHECK(city.getDaysBelow32(1991, 1995) == 50);
+    CHECK(city.getAverageTemperature(1992, 1996) == Approx(54.0f));
+    CHECK_THROWS(city.getAverageTemperature(1993, 1994));
+  }
+
+  SECTION("Unordered years") {
+    CityTemperatureData city("Unordered", unordered, 3);
+    CHECK(city[1999].numDaysAbove90 == 6);
+    CHECK(city.indexOf(2000) == 2);
+    CHECK(city.getDaysAbove90(2000, 2001) == 12);
+    CHECK(city.getAverageMin(1999, 2000) == Approx(33.0f));
+  }
+}
+
+TEST_CASE("Cell Parsing Status", "[Cells]") {
+  int i;
+  float f;
+
+  SECTION("Good cells") {
+    CHECK(parseIntCell("\" 42 \"", i) == CellStatus::OK);
+    CHECK(i == 42);
+    CHECK(parseIntCell("-7", i) == CellStatus::OK);
+    CHECK(i == -7);
+    CHECK(parseFloatCell("'+56.4'", f) == CellStatus::OK);
+    CHECK(f == 56.4f);
+  }
+
+  SECTION("Bad cells") {
+    CHECK(parseIntCell("\"\"", i) == CellStatus::MISSING);
+    CHECK(i == 0);
+    CHECK(parseIntCell("12.5", i) == CellStatus::INVALID);
+    CHECK(parseIntCell("99999999999", i) == CellStatus::OUT_OF_RANGE);
+    CHECK(parseFloatCell("  ", f) == CellStatus::MISSING);
+    CHECK(f != f);  // NaN
+    CHECK(parseFloatCell("abc", f) == CellStatus::INVALID);
+  }
+
+  SECTION("Lines with blank fields") {
+    CityYear cy;
+    CHECK(parseLine("\"S\",\"N\",\"1999\",\"\",\"3\",\"50.5\",\"\",\"40.0\"", cy)
+          == CellStatus::MISSING);
+    CHECK(cy.year == 1999);
+    CHECK(cy.numDaysBelow32 == 0);
+    CHECK(cy.numDaysAbove90 == 3);
+    CHECK(cy.averageMin == 40.0f);
+    CHECK(parseLine("S,N,2000,1", cy) == CellStatus::MISSING);
+    CHECK(parseLine("S,N,2000,1,2,3,4,5", cy) == CellStatus::OK);
+  }
+}
+
+TEST_CASE("Missing Readings", "[Missing]") {
+  // 2001 has no TAVG or TMAX and 2003 has no TMIN
+  ofstream("missing.csv", ios::binary)
+      << "\"STATION\",\"NAME\",\"DATE\",\"DX32\",\"DX90\",\"TAVG\",\"TMAX\",\"TMIN\"\n"
+      << "\"S\",\"GAPPY\",\"2000\",\"10\",\"1\",\"50.0\",\"60.0\",\"40.0\"\n"
+      << "\"S\",\"GAPPY\",\"2001\",\"20\",\"2\",\"\",\"\",\"41.0\"\n"
+      << "\"S\",\"GAPPY\",\"2002\",\"30\",\"3\",\"54.0\",\"64.0\",\"44.0\"\n"
+      << "\"S\",\"GAPPY\",\"2003\",\"40\",\"4\",\"56.0\",\"66.0\",\"\"\n"
+      << "\"S\",\"GAPPY\",\"2004\",\"50\",\"5\",\"58.0\",\"68.0\",\"48.0\"\n";
+  CityTemperatureData* city = readCity("Gappy", "missing.csv", 1, 5);
+  REQUIRE(city->count() == 5);
+
+  SECTION("Range queries after a blank cell") {
+    CHECK(city->getAverageTemperature(2002, 2004) == Approx(56.0f));
+    CHECK(city->getAverageTemperature(2000, 2002) == Approx(52.0f));
+    CHECK(city->getAverageMax(2001, 2004) == Approx(66.0f));
+    CHECK(city->getAverageMin(2003, 2004) == Approx(48.0f));
+    CHECK(city->getDaysBelow32(2002, 2004) == 120);
+    CHECK_THROWS(city->getAverageTemperature(2001, 2001));
+  }
+
+  SECTION("Whole-history aggregates") {
+    CHECK(city->getAllTimeAverage() == Approx(54.5f));
+    CHECK(city->getHighestAverageMax() == 68.0f);
+    CHECK(city->getLowestAverageMin() == 40.0f);
+    CHECK(city->getTotalDaysBelow32() == 150);
+    const float nan = numeric_limits<float>::quiet_NaN();
+    city->append({2005, 0, 0, nan, nan, 30.0f});
+    CHECK(city->getAllTimeAverage() == Approx(54.5f));
+    CHECK(city->getHighestAverageMax() == 68.0f);
+    CHECK(city->getLowestAverageMin() == 30.0f);
+    CHECK(city->getAverageTemperature(2003, 2005) == Approx(57.0f));
+  }
+
+  SECTION("Unordered years") {
+    const float nan = numeric_limits<float>::quiet_NaN();
+    CityYear unordered[3] = {{2001, 1, 5, nan, 50.0f, 30.0f},
+                             {1999, 2, 6, 42.0f, 52.0f, 32.0f},
+                             {2000, 3, 7, 44.0f, 54.0f, 34.0f}};
+    CityTemperatureData shuffled("Unordered", unordered, 3);
+    CHECK(shuffled.getAverageTemperature(1999, 2001) == Approx(43.0f));
+    CHECK_THROWS(shuffled.getAverageTemperature(2001, 2001));
+  }
+
+  delete city;
+  remove("missing.csv");
+}
+
+TEST_CASE("Binary Snapshot", "[Snapshot]") {
+  remove("tempdata.snapshot");
+  CitySnapshot* built = loadCities("tempdata.snapshot", "tempdata.csv");
+  REQUIRE(built != nullptr);
+  delete built;
+
+  // the second load maps the snapshot written by the first
+  CitySnapshot* snapshot = openSnapshot("tempdata.snapshot");
+  REQUIRE(snapshot != nullptr);
+  REQUIRE(snapshot->count() == 2);
+
+  SECTION("Same data as the CSV") {
+    const CityTemperatureData& nyc = (*snapshot)[0];
+    CHECK(nyc.getName() == "NY CITY CENTRAL PARK");
+    CHECK(nyc.count() == 51);
+    CHECK(nyc[2011].averageTemperature == 56.4f);
+    CHECK(nyc.getTotalDaysAbove90() == 891);
+    CHECK((*snapshot)[1].getTotalDaysBelow32() == 3242);
+    CHECK(reinterpret_cast<uintptr_t>(nyc.years()) % SNAPSHOT_ALIGNMENT == 0);
+    CHECK(reinterpret_cast<uintptr_t>(nyc.averageMins()) % SNAPSHOT_ALIGNMENT == 0);
+  }
+
+  SECTION("Same aggregates as the CSV, without rescanning") {
+    const CityTemperatureData& nyc = (*snapshot)[0];
+    CityTemperatureData* parsed = readCity("NYC", "tempdata.csv", 1, 51);
+    CHECK(nyc.getAllTimeAverage() == parsed->getAllTimeAverage());
+    CHECK(nyc.getHighestAverageMax() == parsed->getHighestAverageMax());
+    CHECK(nyc.getLowestAverageMin() == parsed->getLowestAverageMin());
+    CHECK(nyc.indexOf(1990) == 22);
+    CHECK(nyc.getAverageTemperature(1980, 1989) == Approx(55.08f));
+    CHECK(nyc.getDaysBelow32(2010, 3000) == 157);
+    // the running totals are read out of the mapping too
+    CHECK(reinterpret_cast<uintptr_t>(nyc.runningTotals(0)) % SNAPSHOT_ALIGNMENT == 0);
+    delete parsed;
+  }
+
+  SECTION("Rejects other files") {
+    CHECK(openSnapshot("tempdata.csv") == nullptr);
+    CHECK(openSnapshot("missing.snapshot") == nullptr);
+  }
+
+  delete snapshot;
+  remove("tempdata.snapshot");
+}
+
+TEST_CASE("Parallel Parsing", "[Parallel]") {
+  // large enough to be split into several chunks
+  string csv = "STATION,NAME,DATE,DX32,DX90,TAVG,TMAX,TMIN\n";
+  for (int i = 0; i < 6000; i++) {
+    csv += "\"S" + to_string(i / 1000) + "\",\"CITY " + to_string(i / 1000) + "\",\""
+           + to_string(1000 + i % 1000) + "\",\"" + to_string(i % 97) + "\",\"" + to_string(i % 13)
+           + "\",\"" + to_string(i % 50) + ".5\",\"60.25\",\"40.0\"\n";
+  }
+  REQUIRE(csv.size() > 4 * 65536);
+
+  SECTION("Same rows as the sequential parser") {
+    CityYear* sequential = new CityYear[6000];
+    CityYear* parallel = new CityYear[6000];
+    REQUIRE(parseCityYears(csv, 1, 6000, sequential) == 6000);
+    REQUIRE(parseCityYears(csv, 1, 6000, parallel, 4) == 6000);
+    bool same = true;
+    for (int i = 0; i < 6000; i++) {
+      same = same && sequential[i].year == parallel[i].year
+             && sequential[i].numDaysBelow32 == parallel[i].numDaysBelow32
+             && sequential[i].averageTemperature == parallel[i].averageTemperature;
+    }
+    CHECK(same);
+    CHECK(parseCityYears(csv, 2500, 2502, parallel, 4) == 3);
+    CHECK(parallel[0].year == 1000 + 2499 % 1000);
+    CHECK(parseCityYears(csv, 5999, 7000, parallel, 4) == 2);
+    CHECK(parseCityYears(csv, 7000, 8000, parallel, 4) == 0);
+    delete[] sequential;
+    delete[] parallel;
+  }
+
+  SECTION("Same dataset as the sequential reader") {
+    ofstream("parallel.csv", ios::binary) << csv;
+    CityDataset* sequential = readDataset("parallel.csv");
+    CityDataset* parallel = readDataset("parallel.csv", 4);
+    REQUIRE(sequential->count() == 6);
+    REQUIRE(parallel->count() == 6);
+    bool same = true;
+    for (int i = 0; i < 6; i++) {
+      same = same && parallel->getStation(i).station == sequential->getStation(i).station
+             && parallel->getStation(i).offset == sequential->getStation(i).offset
+             && parallel->getStation(i).rowCount == sequential->getStation(i).rowCount
+             && (*parallel)[i].getTotalDaysBelow32() == (*sequential)[i].getTotalDaysBelow32();
+    }
+    CHECK(same);
+    delete sequential;
+    delete parallel;
+    remove("parallel.csv");
+  }
+}
+
+TEST_CASE("Arena Dataset", "[Arena]") {
+  SECTION("Interleaved stations are regrouped") {
+    ofstream("interleaved.csv", ios::binary) << "STATION,NAME,DATE,DX32,DX90,TAVG,TMAX,TMIN\n"
+                                                  "A,AA,2000,1,2,3,4,5\n"
+                                                  "B,BB,2000,6,7,8,9,10\n"
+                                                  "A,AA,2001,11,12,13,14,15\n"
+                                                  "\n"
+                                                  "B,BB,2001,16,17,18,19,20\n";
+    for (int threads : {1, 2}) {
+      CityDataset* dataset = readDataset("interleaved.csv", threads);
+      REQUIRE(dataset->count() == 2);
+      CHECK(dataset->getStation(0).rowCount == 2);
+      CHECK(dataset->getStation(1).offset == 63);
+      CityTemperatureData* b = dataset->find("B");
+      REQUIRE(b != nullptr);
+      CHECK(b->count() == 2);
+      CHECK((*b)[2001].numDaysBelow32 == 16);
+      CHECK(b->getTotalDaysAbove90() == 24);
+      CHECK(b->getDaysAbove90(2001, 2001) == 17);
+      CHECK(dataset->find("A")->getAllTimeAverage() == Approx(8.0f));
+      delete dataset;
+    }
+    remove("interleaved.csv");
+  }
+
+  SECTION("Adopting and moving columns") {
+    int* ints = new int[3 * 4];
+    float* floats = new float[3 * 4];
+    CityColumns columns(ints, floats, 4);
+    columns.set(0, {1990, 5, 6, 50.0f, 60.0f, 40.0f});
+    columns.set(1, {1991, 7, 8, 52.0f, 62.0f, 42.0f});
+    CityTemperatureData adopted("Adopted", ints, floats, 4, 2);
+    CHECK(adopted.years() == ints);
+    CHECK(adopted[1991].numDaysAbove90 == 8);
+
+    CityTemperatureData moved(move(adopted));
+    CHECK(moved.count() == 2);
+    CHECK(moved.years() == ints);
+    CHECK(moved.getName() == "Adopted");
+    CHECK(moved.getTotalDaysBelow32() == 12);
+    CHECK(adopted.count() == 0);
+  }
+}
+
+TEST_CASE("Appending Years", "[Append]") {
+  SECTION("Growth and cached aggregates") {
+    CityYear none[1];
+    CityTemperatureData city("Growing", none, 0);
+    for (int i = 0; i < 100; i++) {
+      city.append({2000 + i, i, 2 * i, static_cast<float>(i), 10.0f + i, -10.0f - i});
+    }
+    CHECK(city.count() == 100);
+    CHECK(city.capacity() >= 100);
+    CHECK(city.capacity() < 256);
+    CHECK(city.getFirstYear() == 2000);
+    CHECK(city.indexOf(2099) == 99);
+    CHECK(city[2050].numDaysAbove90 == 100);
+    CHECK(city.getTotalDaysBelow32() == 4950);
+    CHECK(city.getTotalDaysAbove90() == 9900);
+    CHECK(city.getAllTimeAverage() == Approx(49.5f));
+    CHECK(city.getHighestAverageMax() == 109.0f);
+    CHECK(city.getLowestAverageMin() == -109.0f);
+  }
+
+  SECTION("Range queries see appended years") {
+    CityTemperatureData* nyc = readCity("NYC", "tempdata.csv", 1, 51);
+    CHECK(nyc->getDaysBelow32(1968, 2018) == 967);
+    nyc->append({2019, 10, 20, 60.0f, 70.0f, 50.0f});
+    nyc->append({2021, 1, 2, 40.0f, 80.0f, 30.0f});
+    CHECK(nyc->count() == 53);
+    CHECK(nyc->getTotalDaysBelow32() == 978);
+    CHECK(nyc->getDaysBelow32(1900, 2100) == 978);
+    CHECK(nyc->getDaysAbove90(2019, 2021) == 22);
+    CHECK(nyc->getAverageMax(2019, 2021) == Approx(75.0f));
+    CHECK(nyc->indexOf(2020) == -1);
+    CHECK(nyc->indexOf(2021) == 52);
+    CHECK(nyc->getAllTimeAverage() == Approx((55.25294118f * 51 + 100.0f) / 53).epsilon(0.01));
+    CHECK(nyc->getHighestAverageMax() == 80.0f);
+    CHECK(nyc->getLowestAverageMin() == 30.0f);
+    delete nyc;
+  }
+
+  SECTION("Wrapped columns are copied on first append") {
+    const int years[] = {1990, 1991};
+    const int below[] = {3, 4};
+    const int above[] = {5, 6};
+    const float avg[] = {50.0f, 52.0f};
+    const float maxes[] = {60.0f, 62.0f};
+    const float mins[] = {40.0f, 42.0f};
+    CityTemperatureData city("Wrapped", years, below, above, avg, maxes, mins, 2);
+    CHECK(city.capacity() == 0);
+    city.append({1989, 1, 1, 48.0f, 58.0f, 38.0f});
+    CHECK(city.years() != years);
+    CHECK(years[1] == 1991);
+    CHECK(city.count() == 3);
+    CHECK(city[1989].numDaysBelow32 == 1);
+    CHECK(city.getTotalDaysBelow32() == 8);
+    CHECK(city.getAverageTemperature(1989, 1991) == Approx(50.0f));
+  }
+
+  SECTION("Reserving room up front") {
+    CityYear none[1];
+    CityTemperatureData city("Reserved", none, 0);
+    city.reserve(50);
+    CHECK(city.capacity() == 50);
+    const int* before = city.years();
+    for (int i = 0; i < 50; i++) {
+      city.append({1900 + i, 1, 1, 1.0f, 1.0f, 1.0f});
+    }
+    CHECK(city.years() == before);
+    CHECK(city.getTotalDaysAbove90() == 50);
+  }
+}
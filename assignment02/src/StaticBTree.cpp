@@ -0,0 +1,168 @@
+//
+//  StaticBTree.cpp
+//
+//  Implementation of StaticBTree, with the nodes compared using SSE2 or
+//  AVX2 (picked at run time) where they are available.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#include "StaticBTree.h"
+
+#include <bit>      // for popcount()
+#include <cstdint>  // for uintptr_t
+#include <limits>
+
+#include "simd.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Fills unused keys; it is never less than a key being searched for
+  static const int PADDING = numeric_limits<int>::max();
+
+  // Build every level from the leaves up
+  StaticBTree::StaticBTree(const int array[], const int length) : _length(length) {
+    // nodes in each level, leaves first
+    vector<int> levelSizes = {(length + NODE_KEYS - 1) / NODE_KEYS};
+    while (levelSizes.back() > 1) {
+      levelSizes.push_back((levelSizes.back() + FANOUT - 1) / FANOUT);
+    }
+
+    int numNodes = 0;
+    for (int i = static_cast<int>(levelSizes.size()) - 1; i >= 0; i--) {
+      _levelStarts.push_back(numNodes);
+      numNodes += levelSizes[i];
+    }
+    _storage.resize(static_cast<size_t>(numNodes) * NODE_KEYS + NODE_KEYS, PADDING);
+    uintptr_t misalignment = reinterpret_cast<uintptr_t>(_storage.data()) % 64;
+    _nodes = _storage.data() + (misalignment == 0 ? 0 : (64 - misalignment) / sizeof(int));
+
+    // the leaves are the array, padded out to a whole node
+    int *leaves = _nodes + _levelStarts.back() * NODE_KEYS;
+    for (int i = 0; i < length; i++) {
+      leaves[i] = array[i];
+    }
+
+    // each internal node gets the first key of every child but its first
+    vector<int> firstKeys(levelSizes[0]);
+    for (int i = 0; i < levelSizes[0]; i++) {
+      firstKeys[i] = leaves[i * NODE_KEYS];
+    }
+    for (int level = static_cast<int>(_levelStarts.size()) - 2; level >= 0; level--) {
+      int numChildren = static_cast<int>(firstKeys.size());
+      int numParents = (numChildren + FANOUT - 1) / FANOUT;
+      vector<int> parentFirstKeys(numParents);
+      for (int parent = 0; parent < numParents; parent++) {
+        int *node = _nodes + (_levelStarts[level] + parent) * NODE_KEYS;
+        for (int i = 0; i < NODE_KEYS; i++) {
+          int child = parent * FANOUT + i + 1;
+          node[i] = child < numChildren ? firstKeys[child] : PADDING;
+        }
+        parentFirstKeys[parent] = firstKeys[parent * FANOUT];
+      }
+      firstKeys.swap(parentFirstKeys);
+    }
+
+    _wide = bestSearchIsa() >= SearchIsa::AVX2;
+  }
+
+  // Each rank function gives the number of the 16 sorted keys of *node*
+  // that are less than *key*, which is also the child of an internal node
+  // to descend into
+
+#ifdef CSI281_X86
+  CSI281_TARGET("sse2")
+  static int rankSse2(const int *node, const int key) {
+    __m128i keys = _mm_set1_epi32(key);
+    const __m128i *lanes = reinterpret_cast<const __m128i *>(node);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(keys, _mm_load_si128(lanes))))
+               | _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(keys, _mm_load_si128(lanes + 1))))
+                     << 4
+               | _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(keys, _mm_load_si128(lanes + 2))))
+                     << 8
+               | _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(keys, _mm_load_si128(lanes + 3))))
+                     << 12;
+    return popcount(static_cast<unsigned>(mask));
+  }
+
+  CSI281_TARGET("avx2")
+  static int rankAvx2(const int *node, const int key) {
+    __m256i keys = _mm256_set1_epi32(key);
+    const __m256i *lanes = reinterpret_cast<const __m256i *>(node);
+    __m256i low = _mm256_cmpgt_epi32(keys, _mm256_load_si256(lanes));
+    __m256i high = _mm256_cmpgt_epi32(keys, _mm256_load_si256(lanes + 1));
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(low))
+               | _mm256_movemask_ps(_mm256_castsi256_ps(high)) << 8;
+    return popcount(static_cast<unsigned>(mask));
+  }
+#else
+  static int rankScalar(const int *node, const int key) {
+    int rank = 0;
+    for (int i = 0; i < StaticBTree::NODE_KEYS; i++) {
+      rank += node[i] < key;
+    }
+    return rank;
+  }
+#endif
+
+  // Walk from the root to a leaf with *rank* comparing each node
+  template <int (*rank)(const int *, const int)>
+  static int descend(const int *nodes, const vector<int> &levelStarts, const int key) {
+    int k = 0;  // node within the current level
+    int lastLevel = static_cast<int>(levelStarts.size()) - 1;
+    for (int level = 0; level < lastLevel; level++) {
+      const int *node = nodes + (levelStarts[level] + k) * StaticBTree::NODE_KEYS;
+      k = k * StaticBTree::FANOUT + rank(node, key);
+    }
+    // a rank of 16 in a leaf is the first key of the next leaf
+    const int *leaf = nodes + (levelStarts[lastLevel] + k) * StaticBTree::NODE_KEYS;
+    return k * StaticBTree::NODE_KEYS + rank(leaf, key);
+  }
+
+  int StaticBTree::lowerBound(const int key) const {
+    if (_length == 0) {
+      return 0;
+    }
+    int index;
+#ifdef CSI281_X86
+    if (_wide) {
+      index = descend<rankAvx2>(_nodes, _levelStarts, key);
+    } else {
+      index = descend<rankSse2>(_nodes, _levelStarts, key);
+    }
+#else
+    index = descend<rankScalar>(_nodes, _levelStarts, key);
+#endif
+    return index < _length ? index : _length;
+  }
+
+  int StaticBTree::find(const int key) const {
+    int index = lowerBound(key);
+    if (index == _length) {
+      return -1;
+    }
+    // the leaves hold the array in order, so the element is right there
+    const int *leaves = _nodes + _levelStarts.back() * NODE_KEYS;
+    return leaves[index] == key ? index : -1;
+  }
+}  // namespace csi281
@@ -0,0 +1,76 @@
+//
+//  StaticBTree.h
+//
+//  A read-only B+ tree over a sorted int array whose nodes are each one
+//  cache line, so a search touches one cache line per level.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef StaticBTree_hpp
+#define StaticBTree_hpp
+
+#include <vector>
+
+#include "MemoryLeakDetector.h"
+#include "search.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // An implicit (pointer free) B+ tree built once from a sorted int array
+  // Every node is 16 ints on a 64 byte boundary. The leaves hold the array
+  // itself; an internal node holds the first key of each of its children
+  // but the first, so it has 17 children, and the children of node k of a
+  // level are nodes 17k to 17k + 16 of the level below. Each node is
+  // searched with a few vector comparisons instead of four dependent
+  // branches, and a search reads one cache line per level, about
+  // log17(n) in all, instead of one per step of binary search
+  class StaticBTree {
+  public:
+    StaticBTree(const int array[], const int length);
+    StaticBTree(const StaticBTree &) = delete;
+    StaticBTree &operator=(const StaticBTree &) = delete;
+
+    int count() const { return _length; }
+
+    // Location of the first element that is not less than *key*
+    // (count() if there is none), as lowerBound() gives
+    int lowerBound(const int key) const;
+
+    // First location of *key*, or -1 if it is never found, as
+    // binarySearch() gives
+    int find(const int key) const;
+
+    static const int NODE_KEYS = 16;
+    static const int FANOUT = NODE_KEYS + 1;
+
+  private:
+    vector<int> _storage;       // the nodes, plus room to align them
+    int *_nodes;                // first node of the root level, 64 byte aligned
+    vector<int> _levelStarts;   // first node of each level, root level first
+    int _length;                // number of elements in the original array
+    bool _wide;                 // compare nodes with AVX2 rather than SSE2
+  };
+}  // namespace csi281
+
+#endif /* StaticBTree_hpp */
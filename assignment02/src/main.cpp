@@ -38,46 +38,30 @@ using namespace std;
 using namespace csi281;
 using namespace SVGChart;
 
-// Draw a chart showing the average search times
-// for different numbers of elements in "SearchChart.svg"
-static void drawSearchChart() {
-  PPlot pplot;
-  pplot.mPlotBackground.mTitle = "Number of Elements Versus Time (1000 samples at each N)";
-
-  PlotData *theX1 = new PlotData();
-  PlotData *theY1 = new PlotData();
-  LineDataDrawer *theDataDrawer1 = new LineDataDrawer();
-  theDataDrawer1->mDrawPoint = false;
-  theDataDrawer1->mDrawLine = true;
-
-  LegendData *legend1 = new LegendData();  // let us setup the first legend
-  legend1->mName = "Linear Search";
-  legend1->mColor = PColor(200, 0, 100);  // just an rgb value
+// Number of lines on each chart
+static const int NUM_LINES = 4;
 
-  PlotData *theX2 = new PlotData();
-  PlotData *theY2 = new PlotData();
-  LineDataDrawer *theDataDrawer2 = new LineDataDrawer();
-  theDataDrawer2->mDrawPoint = false;
-  theDataDrawer2->mDrawLine = true;
-
-  LegendData *legend2 = new LegendData();  // let us setup the first legend
-  legend2->mName = "Binary Search (w/ Sort Amortized)";
-  legend2->mColor = PColor(100, 20, 220);  // just an rgb value
-
-  cout << "Generating times for large arrays; this may take a while..." << endl;
+// Draw a chart titled *title* of median time versus N in *fileName*,
+// with one line per name in *names* through the points in *xs* and *ys*
+// The chart takes ownership of *xs* and *ys*
+static void drawChart(const char *title, const char *const names[NUM_LINES],
+                      PlotData *const xs[NUM_LINES], PlotData *const ys[NUM_LINES],
+                      const char *fileName) {
+  PPlot pplot;
+  pplot.mPlotBackground.mTitle = title;
 
-  const int NUM_TESTS = 1000;
-  for (int i = 100; i <= 10000; i *= 2) {
-    auto speeds = arraySearchSpeed(i, NUM_TESTS);
-    theX1->push_back(i);
-    theY1->push_back(speeds.first.count());
-    theX2->push_back(i);
-    theY2->push_back(speeds.second.count());
+  const PColor colors[NUM_LINES] = {PColor(200, 0, 100), PColor(100, 20, 220),
+                                    PColor(220, 100, 0), PColor(0, 150, 100)};
+  for (int line = 0; line < NUM_LINES; line++) {
+    LineDataDrawer *drawer = new LineDataDrawer();
+    drawer->mDrawPoint = false;
+    drawer->mDrawLine = true;
+    LegendData *legend = new LegendData();
+    legend->mName = names[line];
+    legend->mColor = colors[line];
+    pplot.mPlotDataContainer.AddXYPlot(xs[line], ys[line], legend, drawer);
   }
 
-  pplot.mPlotDataContainer.AddXYPlot(theX1, theY1, legend1, theDataDrawer1);
-  pplot.mPlotDataContainer.AddXYPlot(theX2, theY2, legend2, theDataDrawer2);
-
   pplot.mMargins.mLeft = 100;
   pplot.mMargins.mTop = 50;
   pplot.mMargins.mRight = 50;
@@ -91,15 +75,87 @@ static void drawSearchChart() {
   pplot.mYAxisSetup.mAutoScaleMax = true;
   pplot.mYAxisSetup.mMin = 0;
   pplot.mXAxisSetup.mMin = 0;
-  // pplot.mYAxisSetup.mMax = 100;
-  pplot.mYAxisSetup.mLabel = "Time (nanoseconds)";
+  pplot.mYAxisSetup.mLabel = "Median Time (nanoseconds)";
   SVGPainter painter(800, 600);
   pplot.Draw(painter);
-  painter.writeFile("SearchChart.svg");
+  painter.writeFile(fileName);
+}
+
+// Draw a chart showing the median search times with a hot and a cold
+// cache for different numbers of elements in "SearchChart.svg", and
+// print the median, 99th percentile and searches per second of each
+static void drawSearchChart() {
+  const char *names[NUM_LINES] = {"Linear Search (Hot Cache)", "Binary Search (Hot Cache)",
+                                  "Linear Search (Cold Cache)", "Binary Search (Cold Cache)"};
+  PlotData *xs[NUM_LINES];
+  PlotData *ys[NUM_LINES];
+  for (int line = 0; line < NUM_LINES; line++) {
+    xs[line] = new PlotData();
+    ys[line] = new PlotData();
+  }
+
+  cout << "Generating times for large arrays; this may take a while..." << endl;
+  cout << "N, cache, algorithm, median (ns), p99 (ns), searches/sec" << endl;
+
+  const int NUM_TESTS = 1000;
+  const CacheState caches[2] = {CacheState::HOT, CacheState::COLD};
+  for (int i = 100; i <= 10000; i *= 2) {
+    for (int c = 0; c < 2; c++) {
+      SearchBenchmark benchmark = searchBenchmark(i, NUM_TESTS, caches[c]);
+      const SearchTiming *timings[2] = {&benchmark.linearSearch, &benchmark.binarySearch};
+      for (int algorithm = 0; algorithm < 2; algorithm++) {
+        const SearchTiming &timing = *timings[algorithm];
+        xs[2 * c + algorithm]->push_back(i);
+        ys[2 * c + algorithm]->push_back(timing.median.count());
+        cout << i << ", " << (c == 0 ? "hot" : "cold") << ", "
+             << (algorithm == 0 ? "linear" : "binary") << ", " << timing.median.count() << ", "
+             << timing.p99.count() << ", " << timing.opsPerSecond << endl;
+      }
+    }
+  }
+
+  drawChart("Number of Elements Versus Median Time (1000 samples at each N)", names, xs, ys,
+            "SearchChart.svg");
+}
+
+// Draw a chart comparing binarySearch() with a LearnedIndex on uniform
+// and skewed keys in "LearnedIndexChart.svg", and print how big each
+// model was
+static void drawLearnedIndexChart() {
+  const char *names[NUM_LINES] = {"Binary Search (Uniform)", "Learned Index (Uniform)",
+                                  "Binary Search (Skewed)", "Learned Index (Skewed)"};
+  PlotData *xs[NUM_LINES];
+  PlotData *ys[NUM_LINES];
+  for (int line = 0; line < NUM_LINES; line++) {
+    xs[line] = new PlotData();
+    ys[line] = new PlotData();
+  }
+
+  cout << "Comparing learned index and binary search..." << endl;
+
+  const int NUM_TESTS = 10000;
+  for (int i = 1000; i <= 1024000; i *= 4) {
+    for (int skewed = 0; skewed <= 1; skewed++) {
+      LearnedIndexSpeed speed = learnedIndexSpeed(i, NUM_TESTS, skewed);
+      xs[2 * skewed]->push_back(i);
+      ys[2 * skewed]->push_back(speed.binarySearch.median.count());
+      xs[2 * skewed + 1]->push_back(i);
+      ys[2 * skewed + 1]->push_back(speed.learnedIndex.median.count());
+      cout << "N = " << i << (skewed ? " skewed: " : " uniform: ") << "binary search "
+           << speed.binarySearch.median.count() << " ns, learned index "
+           << speed.learnedIndex.median.count()
+           << " ns with " << speed.segments << " segments in " << speed.modelBytes << " bytes"
+           << endl;
+    }
+  }
+
+  drawChart("Learned Index Versus Binary Search (10000 samples at each N)", names, xs, ys,
+            "LearnedIndexChart.svg");
 }
 
 // Test all code and draw charts.
 int main(int argc, char *argv[]) {
   // draw chart
   drawSearchChart();
+  drawLearnedIndexChart();
 }
@@ -0,0 +1,264 @@
+//
+//  search.cpp
+//
+//  Vectorized linearSearch() for int, float and double arrays, with the
+//  kernel picked at run time from the instruction sets the CPU supports.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#include "search.h"
+
+#include <bit>  // for countr_zero()
+
+#include "simd.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Compare the elements from *start* on one at a time
+  template <typename T>
+  static ptrdiff_t scalarSearch(const T array[], ptrdiff_t start, const ptrdiff_t length,
+                                const T key) {
+    for (ptrdiff_t i = start; i < length; i++) {
+      if (key == array[i]) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+#ifdef CSI281_X86
+  // Each kernel compares one vector of elements per step, turns the result
+  // into a bit mask of the equal lanes and returns at the lowest set bit;
+  // the elements left over after the last whole vector are compared one
+  // at a time. Float comparisons are ordered, so as with == a NaN key
+  // never matches and -0.0 matches 0.0
+
+  CSI281_TARGET("sse2")
+  static ptrdiff_t searchSse2(const int array[], const ptrdiff_t length, const int key) {
+    __m128i keys = _mm_set1_epi32(key);
+    ptrdiff_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+      __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(array + i));
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(values, keys)));
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("sse2")
+  static ptrdiff_t searchSse2(const float array[], const ptrdiff_t length, const float key) {
+    __m128 keys = _mm_set1_ps(key);
+    ptrdiff_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+      int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(array + i), keys));
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("sse2")
+  static ptrdiff_t searchSse2(const double array[], const ptrdiff_t length, const double key) {
+    __m128d keys = _mm_set1_pd(key);
+    ptrdiff_t i = 0;
+    for (; i + 2 <= length; i += 2) {
+      int mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(array + i), keys));
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("avx2")
+  static ptrdiff_t searchAvx2(const int array[], const ptrdiff_t length, const int key) {
+    __m256i keys = _mm256_set1_epi32(key);
+    ptrdiff_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+      __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(array + i));
+      int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(values, keys)));
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("avx2")
+  static ptrdiff_t searchAvx2(const float array[], const ptrdiff_t length, const float key) {
+    __m256 keys = _mm256_set1_ps(key);
+    ptrdiff_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+      int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(array + i), keys, _CMP_EQ_OQ));
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("avx2")
+  static ptrdiff_t searchAvx2(const double array[], const ptrdiff_t length, const double key) {
+    __m256d keys = _mm256_set1_pd(key);
+    ptrdiff_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+      int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(array + i), keys, _CMP_EQ_OQ));
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("avx512f")
+  static ptrdiff_t searchAvx512(const int array[], const ptrdiff_t length, const int key) {
+    __m512i keys = _mm512_set1_epi32(key);
+    ptrdiff_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+      __mmask16 mask = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(array + i), keys);
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("avx512f")
+  static ptrdiff_t searchAvx512(const float array[], const ptrdiff_t length, const float key) {
+    __m512 keys = _mm512_set1_ps(key);
+    ptrdiff_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+      __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(array + i), keys, _CMP_EQ_OQ);
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  CSI281_TARGET("avx512f")
+  static ptrdiff_t searchAvx512(const double array[], const ptrdiff_t length, const double key) {
+    __m512d keys = _mm512_set1_pd(key);
+    ptrdiff_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+      __mmask8 mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(array + i), keys, _CMP_EQ_OQ);
+      if (mask != 0) {
+        return i + countr_zero(static_cast<unsigned>(mask));
+      }
+    }
+    return scalarSearch(array, i, length, key);
+  }
+
+  // Ask the CPU (and, for AVX, the operating system, which has to save
+  // the wider registers) which instruction sets can be used
+  static SearchIsa detectSearchIsa() {
+#  if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    if (osSavesAvx && (info[1] & (1 << 16)) != 0 && (_xgetbv(0) & 0xE6) == 0xE6) {
+      return SearchIsa::AVX512;
+    }
+    if (osSavesAvx && (info[1] & (1 << 5)) != 0) {
+      return SearchIsa::AVX2;
+    }
+    return SearchIsa::SSE2;
+#  else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return SearchIsa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return SearchIsa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return SearchIsa::SSE2;
+    }
+    return SearchIsa::SCALAR;
+#  endif
+  }
+#else
+  static SearchIsa detectSearchIsa() { return SearchIsa::SCALAR; }
+#endif
+
+  SearchIsa bestSearchIsa() {
+    static const SearchIsa best = detectSearchIsa();
+    return best;
+  }
+
+  // Run the kernel for *isa*, or for the best supported set if that is narrower
+  template <typename T>
+  static ptrdiff_t dispatchSearch(SearchIsa isa, const T array[], const ptrdiff_t length,
+                                  const T key) {
+    if (isa > bestSearchIsa()) {
+      isa = bestSearchIsa();
+    }
+    switch (isa) {
+#ifdef CSI281_X86
+      case SearchIsa::AVX512:
+        return searchAvx512(array, length, key);
+      case SearchIsa::AVX2:
+        return searchAvx2(array, length, key);
+      case SearchIsa::SSE2:
+        return searchSse2(array, length, key);
+#endif
+      default:
+        return scalarSearch(array, 0, length, key);
+    }
+  }
+
+  ptrdiff_t linearSearchWith(SearchIsa isa, const int array[], const ptrdiff_t length,
+                             const int key) {
+    return dispatchSearch(isa, array, length, key);
+  }
+
+  ptrdiff_t linearSearchWith(SearchIsa isa, const float array[], const ptrdiff_t length,
+                             const float key) {
+    return dispatchSearch(isa, array, length, key);
+  }
+
+  ptrdiff_t linearSearchWith(SearchIsa isa, const double array[], const ptrdiff_t length,
+                             const double key) {
+    return dispatchSearch(isa, array, length, key);
+  }
+
+  template <>
+  ptrdiff_t linearSearch<int>(const int array[], const ptrdiff_t length, const int key) {
+    return dispatchSearch(bestSearchIsa(), array, length, key);
+  }
+
+  template <>
+  ptrdiff_t linearSearch<float>(const float array[], const ptrdiff_t length, const float key) {
+    return dispatchSearch(bestSearchIsa(), array, length, key);
+  }
+
+  template <>
+  ptrdiff_t linearSearch<double>(const double array[], const ptrdiff_t length, const double key) {
+    return dispatchSearch(bestSearchIsa(), array, length, key);
+  }
+}  // namespace csi281
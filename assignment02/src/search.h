@@ -29,14 +29,39 @@
 #ifndef search_hpp
 #define search_hpp
 
+#include <algorithm>  // for max()
+#include <bit>        // for bit_width(), countr_one()
+#include <cstddef>  // for ptrdiff_t
+#include <iterator>  // for ssize()
+#include <span>
+#include <type_traits>
+#include <vector>
+
 #include "MemoryLeakDetector.h"
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <xmmintrin.h>  // for _mm_prefetch()
+#endif
+
+using namespace std;
+
 namespace csi281 {
 
+  // Ask for the cache line holding *address* to be loaded ahead of use
+  // It is only a hint, so an address past the end of an array is harmless
+  inline void prefetch(const void *address) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+    __builtin_prefetch(address);
+#endif
+  }
+
   // Returns the first location of the found key
   // or -1 if the key is never found
-  template <typename T> int linearSearch(T array[], const int length, const T key) {
-    for (int i = 0; i < length; i++) {
+  template <typename T>
+  ptrdiff_t linearSearch(const T array[], const ptrdiff_t length, const T key) {
+    for (ptrdiff_t i = 0; i < length; i++) {
       if (key == array[i]) {
         return i;
       }
@@ -45,12 +70,41 @@ namespace csi281 {
     return -1;
   }
 
+  // Vector instruction sets that linearSearch() of int, float and double can use
+  enum class SearchIsa { SCALAR, SSE2, AVX2, AVX512 };
+
+  // The widest of the above this CPU supports, detected once
+  SearchIsa bestSearchIsa();
+
+  // linearSearch() using *isa*, or the best supported one if the CPU lacks it
+  ptrdiff_t linearSearchWith(SearchIsa isa, const int array[], const ptrdiff_t length,
+                             const int key);
+  ptrdiff_t linearSearchWith(SearchIsa isa, const float array[], const ptrdiff_t length,
+                             const float key);
+  ptrdiff_t linearSearchWith(SearchIsa isa, const double array[], const ptrdiff_t length,
+                             const double key);
+
+  // int, float and double arrays are compared 2 to 16 elements at a time
+  // with the widest vector instructions the CPU supports (see search.cpp)
+  template <> ptrdiff_t linearSearch<int>(const int array[], const ptrdiff_t length, const int key);
+  template <>
+  ptrdiff_t linearSearch<float>(const float array[], const ptrdiff_t length, const float key);
+  template <>
+  ptrdiff_t linearSearch<double>(const double array[], const ptrdiff_t length, const double key);
+
   // Returns the first location of the found key
   // or -1 if the key is never found; assumes a sorted array
-  template <typename T> int binarySearch(T array[], const int length, const T key) {
-    int left = 0;
-    int right = length - 1;
-    int middle = (right - left) / 2;
+  template <typename T>
+  ptrdiff_t binarySearch(const T array[], const ptrdiff_t length, const T key) {
+    // nothing to read, and array may be null
+    if (length <= 0) {
+      return -1;
+    }
+    ptrdiff_t left = 0;
+    ptrdiff_t right = length - 1;
+    // left + (right - left) / 2 rather than (left + right) / 2, which
+    // could overflow for the largest arrays
+    ptrdiff_t middle = (right - left) / 2;
 
     bool found = false;
     while (!found) {
@@ -70,7 +124,500 @@ namespace csi281 {
         middle = (right - left) / 2 + left;
       }
     }
+    return -1;
+  }
+
+  // Returns the location of the first element that is not less than
+  // *key* (*length* if there is none); assumes a sorted array
+  // The range is halved the same number of times for every key and the
+  // comparison only picks which half to keep, so the compiler can turn it
+  // into a conditional move instead of a hard to predict branch
+  template <typename T>
+  ptrdiff_t lowerBound(const T array[], const ptrdiff_t length, const T key) {
+    if (length <= 0) {
+      return 0;
+    }
+    const T *base = array;
+    ptrdiff_t remaining = length;
+    while (remaining > 1) {
+      ptrdiff_t half = remaining / 2;
+      base = (base[half] < key) ? base + half : base;
+      remaining -= half;
+    }
+    return (base - array) + (*base < key);
+  }
+
+  // Returns the first location of the found key
+  // or -1 if the key is never found; assumes a sorted array
+  // Same answers as binarySearch(), but without a data dependent branch
+  template <typename T>
+  ptrdiff_t branchlessBinarySearch(const T array[], const ptrdiff_t length, const T key) {
+    ptrdiff_t index = lowerBound(array, length, key);
+    return (index < length && array[index] == key) ? index : -1;
+  }
+
+  // Returns the location of the first element that is not less than
+  // *key* (*length* if there is none); assumes a sorted array of numbers
+  // Each probe is placed where the key would be if the values between
+  // the ends of the remaining range were evenly spread, which takes about
+  // log2(log2(n)) probes on uniform data. Badly spread data could take n
+  // probes, so after log2(n) of them the rest is left to lowerBound()
+  template <typename T>
+  ptrdiff_t interpolationLowerBound(const T array[], const ptrdiff_t length, const T key) {
+    static_assert(is_arithmetic_v<T>, "interpolation needs numeric keys");
+    ptrdiff_t low = 0;        // everything before low is less than key
+    ptrdiff_t high = length;  // nothing from high on is less than key
+    for (int probes = bit_width(static_cast<size_t>(length)); probes > 0; probes--) {
+      if (low == high || !(array[low] < key)) {
+        return low;
+      }
+      if (array[high - 1] < key) {
+        return high;
+      }
+      // array[low] < key <= array[high - 1], so the range holds distinct values
+      double fraction = (static_cast<double>(key) - static_cast<double>(array[low]))
+                        / (static_cast<double>(array[high - 1]) - static_cast<double>(array[low]));
+      ptrdiff_t probe = low + static_cast<ptrdiff_t>(fraction * (high - 1 - low));
+      if (array[probe] < key) {
+        low = probe + 1;
+      } else {
+        high = probe;
+      }
+    }
+    return low + lowerBound(array + low, high - low, key);
+  }
+
+  // Returns the first location of the found key
+  // or -1 if the key is never found; assumes a sorted array of numbers
+  template <typename T>
+  ptrdiff_t interpolationSearch(const T array[], const ptrdiff_t length, const T key) {
+    ptrdiff_t index = interpolationLowerBound(array, length, key);
+    return (index < length && array[index] == key) ? index : -1;
+  }
+
+  // Returns the location of the first element that is not less than
+  // *key* (*length* if there is none); assumes a sorted array
+  // Gallops away from *hint* in steps of 1, 2, 4, ... until the key is
+  // passed, then binary searches the last step, so a key d places from
+  // the hint takes about 2 log2(d) comparisons however long the array is
+  template <typename T>
+  ptrdiff_t exponentialLowerBound(const T array[], const ptrdiff_t length, const T key,
+                                  ptrdiff_t hint = 0) {
+    if (length <= 0) {
+      return 0;
+    }
+    hint = hint < 0 ? 0 : (hint >= length ? length - 1 : hint);
+    ptrdiff_t low, high;  // the answer is in [low, high]
+    if (array[hint] < key) {
+      // gallop right; everything up to low is less than key
+      low = hint + 1;
+      ptrdiff_t step = 1;
+      while (low + step - 1 < length && array[low + step - 1] < key) {
+        low += step;
+        step *= 2;
+      }
+      high = low + step - 1 < length ? low + step - 1 : length;
+    } else {
+      // gallop left; array[high] is not less than key
+      high = hint;
+      ptrdiff_t step = 1;
+      while (high - step >= 0 && !(array[high - step] < key)) {
+        high -= step;
+        step *= 2;
+      }
+      low = high - step + 1 > 0 ? high - step + 1 : 0;
+    }
+    return low + lowerBound(array + low, high - low, key);
+  }
+
+  // Returns the first location of the found key or -1 if the key is
+  // never found, searching outward from *hint*; assumes a sorted array
+  template <typename T>
+  ptrdiff_t exponentialSearch(const T array[], const ptrdiff_t length, const T key,
+                              const ptrdiff_t hint = 0) {
+    ptrdiff_t index = exponentialLowerBound(array, length, key, hint);
+    return (index < length && array[index] == key) ? index : -1;
   }
+
+  // The ways AdaptiveSearch can search an array
+  enum class SearchStrategy { LINEAR, BINARY, INTERPOLATION };
+
+  // Searches one sorted array with whichever strategy suits it, picked
+  // once from a sample of the array: a scan for arrays of a few cache
+  // lines, interpolation when the sampled values grow close to linearly,
+  // and branchless binary search otherwise. Searches given a hint gallop
+  // from it with exponentialLowerBound() whatever the strategy. The array
+  // must outlive the AdaptiveSearch and not change, as the choice is
+  // never revisited
+  template <typename T> class AdaptiveSearch {
+  public:
+    // Arrays this short are scanned
+    static const int LINEAR_LIMIT = 32;
+    // Elements sampled to judge how evenly the values are spread
+    static const int NUM_SAMPLES = 64;
+    // Interpolate if no sample is further than this fraction of the
+    // array from where a perfectly even spread would put it
+    static constexpr double MAX_SKEW = 0.05;
+
+    AdaptiveSearch(const T array[], const ptrdiff_t length)
+        : _array(array), _length(length), _strategy(chooseStrategy()) {}
+
+    SearchStrategy strategy() const { return _strategy; }
+
+    // Location of the first element that is not less than *key*
+    // (*length* if there is none), as lowerBound() gives
+    ptrdiff_t lowerBound(const T key) const {
+      switch (_strategy) {
+        case SearchStrategy::LINEAR: {
+          ptrdiff_t i = 0;
+          while (i < _length && _array[i] < key) {
+            i++;
+          }
+          return i;
+        }
+        case SearchStrategy::INTERPOLATION:
+          if constexpr (is_arithmetic_v<T>) {
+            return interpolationLowerBound(_array, _length, key);
+          }
+          [[fallthrough]];
+        default:
+          return csi281::lowerBound(_array, _length, key);
+      }
+    }
+
+    // Same as above for a key that is probably near location *hint*
+    ptrdiff_t lowerBound(const T key, const ptrdiff_t hint) const {
+      return exponentialLowerBound(_array, _length, key, hint);
+    }
+
+    // First location of *key*, or -1 if it is never found, as
+    // binarySearch() gives
+    ptrdiff_t search(const T key) const { return found(key, lowerBound(key)); }
+    ptrdiff_t search(const T key, const ptrdiff_t hint) const {
+      return found(key, lowerBound(key, hint));
+    }
+
+  private:
+    ptrdiff_t found(const T key, const ptrdiff_t index) const {
+      return (index < _length && _array[index] == key) ? index : -1;
+    }
+
+    // Sample the array once to decide how it will be searched
+    SearchStrategy chooseStrategy() const {
+      if (_length <= LINEAR_LIMIT) {
+        return SearchStrategy::LINEAR;
+      }
+      if constexpr (is_arithmetic_v<T>) {
+        double first = static_cast<double>(_array[0]);
+        double range = static_cast<double>(_array[_length - 1]) - first;
+        if (range <= 0) {
+          return SearchStrategy::BINARY;  // every element is the same
+        }
+        double worst = 0;
+        for (int s = 0; s < NUM_SAMPLES; s++) {
+          ptrdiff_t position = s * (_length - 1) / (NUM_SAMPLES - 1);
+          double expected = (static_cast<double>(_array[position]) - first) / range;
+          double skew = expected - static_cast<double>(position) / (_length - 1);
+          worst = max(worst, skew < 0 ? -skew : skew);
+        }
+        if (worst <= MAX_SKEW) {
+          return SearchStrategy::INTERPOLATION;
+        }
+      }
+      return SearchStrategy::BINARY;
+    }
+
+    const T *_array;           // the sorted array being searched
+    ptrdiff_t _length;         // number of elements in _array
+    SearchStrategy _strategy;  // picked by chooseStrategy() at construction
+  };
+
+  // A learned index over a sorted array of numbers: a piecewise linear
+  // model predicts where a key sits, and a binary search of the few
+  // elements around the prediction finishes the lookup
+  // The model is fit greedily (the "shrinking cone" method) so that every
+  // distinct key of a segment is predicted within *maxError* positions of
+  // its first location; the error each segment actually reached is kept
+  // and bounds its final search. The array must outlive the index
+  template <typename T> class LearnedIndex {
+    static_assert(is_arithmetic_v<T>, "a LearnedIndex models numeric keys");
+
+  public:
+    LearnedIndex(const T array[], const ptrdiff_t length, const int maxError = 32)
+        : _array(array), _length(length) {
+      fit(maxError);
+    }
+
+    ptrdiff_t count() const { return _length; }
+    ptrdiff_t segmentCount() const { return static_cast<ptrdiff_t>(_segments.size()); }
+    // Memory taken by the model, not counting the array it indexes
+    size_t modelBytes() const { return _segments.size() * (sizeof(Segment) + sizeof(T)); }
+
+    // Location of the first element that is not less than *key*
+    // (count() if there is none), as lowerBound() gives
+    ptrdiff_t lowerBound(const T key) const {
+      if (_length == 0) {
+        return 0;
+      }
+      // the last segment starting at or before the key
+      ptrdiff_t segment = csi281::lowerBound(_firstKeys.data(), segmentCount(), key);
+      if (segment == segmentCount() || _firstKeys[segment] != key) {
+        segment--;
+      }
+      if (segment < 0) {
+        return 0;
+      }
+
+      const Segment &s = _segments[segment];
+      double predicted = s.start + s.slope * (static_cast<double>(key) - _firstKeys[segment]);
+      ptrdiff_t low = clampIndex(predicted - s.maxError - 1);
+      ptrdiff_t high = clampIndex(predicted + s.maxError + 2);
+      ptrdiff_t index = low + csi281::lowerBound(_array + low, high - low, key);
+      // keys between those that were fit (or past the last one of a
+      // segment) can land outside the window; check and fall back
+      bool afterSmaller = index == 0 || _array[index - 1] < key;
+      bool atNotSmaller = index == _length || !(_array[index] < key);
+      if (afterSmaller && atNotSmaller) {
+        return index;
+      }
+      return csi281::lowerBound(_array, _length, key);
+    }
+
+    // First location of *key*, or -1 if it is never found, as
+    // binarySearch() gives
+    ptrdiff_t search(const T key) const {
+      ptrdiff_t index = lowerBound(key);
+      return (index < _length && _array[index] == key) ? index : -1;
+    }
+
+  private:
+    struct Segment {
+      ptrdiff_t start;  // location of the segment's first key
+      double slope;     // positions per unit of key
+      int maxError;     // furthest any of its keys is from where it is predicted
+    };
+
+    ptrdiff_t clampIndex(const double position) const {
+      if (position <= 0) {
+        return 0;
+      }
+      return position >= _length ? _length : static_cast<ptrdiff_t>(position);
+    }
+
+    // Split the array into segments whose keys lie within *maxError*
+    // positions of one line, keeping each segment's cone of possible
+    // slopes and starting a new segment when the cone becomes empty
+    void fit(const int maxError) {
+      ptrdiff_t start = 0;
+      double low = 0, high = 0;
+      bool open = false;  // has the current segment seen a second key
+      for (ptrdiff_t i = 1; i < _length; i++) {
+        // only the first location of each distinct key is modeled
+        if (!(_array[i - 1] < _array[i])) {
+          continue;
+        }
+        double dx = static_cast<double>(_array[i]) - static_cast<double>(_array[start]);
+        double slopeLow = (i - start - maxError) / dx;
+        double slopeHigh = (i - start + maxError) / dx;
+        if (!open) {
+          low = slopeLow;
+          high = slopeHigh;
+          open = true;
+        } else if (slopeLow > high || slopeHigh < low) {
+          addSegment(start, i, (low + high) / 2);
+          start = i;
+          open = false;
+        } else {
+          low = low > slopeLow ? low : slopeLow;
+          high = high < slopeHigh ? high : slopeHigh;
+        }
+      }
+      if (_length > 0) {
+        addSegment(start, _length, open ? (low + high) / 2 : 0);
+      }
+    }
+
+    // Record the segment of the locations [start, end) and how far its
+    // keys ended up from their predictions
+    void addSegment(const ptrdiff_t start, const ptrdiff_t end, const double slope) {
+      Segment segment = {start, slope, 0};
+      double firstKey = static_cast<double>(_array[start]);
+      for (ptrdiff_t i = start; i < end; i++) {
+        if (i > start && !(_array[i - 1] < _array[i])) {
+          continue;
+        }
+        double error = start + slope * (static_cast<double>(_array[i]) - firstKey) - i;
+        int distance = static_cast<int>(error < 0 ? -error : error) + 1;
+        segment.maxError = segment.maxError > distance ? segment.maxError : distance;
+      }
+      _segments.push_back(segment);
+      _firstKeys.push_back(_array[start]);
+    }
+
+    const T *_array;     // the sorted array being indexed
+    ptrdiff_t _length;   // number of elements in _array
+    vector<Segment> _segments;
+    vector<T> _firstKeys;  // key at the start of each segment, for finding the segment
+  };
+
+  // Number of searches batchBinarySearch() advances together
+  const int SEARCH_BATCH_GROUP = 16;
+
+  // Search a sorted array for each of the *numKeys* *keys*, writing the
+  // first location of keys[i] (or -1 if it is never found) to results[i]
+  // A group of searches is advanced in lockstep: every round prefetches
+  // the next probe of each search in the group before any of them is
+  // compared, so their cache misses overlap instead of each search
+  // waiting on its own chain of misses. As in lowerBound() every search
+  // of an array takes the same number of rounds, so they never diverge
+  template <typename T>
+  void batchBinarySearch(const T array[], const ptrdiff_t length, const T keys[],
+                         const ptrdiff_t numKeys, ptrdiff_t results[]) {
+    const T *bases[SEARCH_BATCH_GROUP];
+    for (ptrdiff_t start = 0; start < numKeys; start += SEARCH_BATCH_GROUP) {
+      int groupSize = numKeys - start < SEARCH_BATCH_GROUP ? static_cast<int>(numKeys - start)
+                                                           : SEARCH_BATCH_GROUP;
+      const T *groupKeys = keys + start;
+      if (length <= 0) {
+        for (int j = 0; j < groupSize; j++) {
+          results[start + j] = -1;
+        }
+        continue;
+      }
+
+      for (int j = 0; j < groupSize; j++) {
+        bases[j] = array;
+      }
+      ptrdiff_t remaining = length;
+      while (remaining > 1) {
+        ptrdiff_t half = remaining / 2;
+        for (int j = 0; j < groupSize; j++) {
+          prefetch(bases[j] + half);
+        }
+        for (int j = 0; j < groupSize; j++) {
+          bases[j] = (bases[j][half] < groupKeys[j]) ? bases[j] + half : bases[j];
+        }
+        remaining -= half;
+      }
+
+      for (int j = 0; j < groupSize; j++) {
+        ptrdiff_t index = (bases[j] - array) + (*bases[j] < groupKeys[j]);
+        results[start + j] = (index < length && array[index] == groupKeys[j]) ? index : -1;
+      }
+    }
+  }
+
+  // The searches above for a std::span rather than a pointer and a length
+
+  template <typename T, size_t N>
+  ptrdiff_t linearSearch(span<T, N> array, const remove_cv_t<T> key) {
+    return linearSearch<remove_cv_t<T>>(array.data(), ssize(array), key);
+  }
+
+  template <typename T, size_t N>
+  ptrdiff_t binarySearch(span<T, N> array, const remove_cv_t<T> key) {
+    return binarySearch<remove_cv_t<T>>(array.data(), ssize(array), key);
+  }
+
+  template <typename T, size_t N> ptrdiff_t lowerBound(span<T, N> array, const remove_cv_t<T> key) {
+    return lowerBound<remove_cv_t<T>>(array.data(), ssize(array), key);
+  }
+
+  template <typename T, size_t N>
+  ptrdiff_t branchlessBinarySearch(span<T, N> array, const remove_cv_t<T> key) {
+    return branchlessBinarySearch<remove_cv_t<T>>(array.data(), ssize(array), key);
+  }
+
+  template <typename T, size_t N>
+  ptrdiff_t interpolationLowerBound(span<T, N> array, const remove_cv_t<T> key) {
+    return interpolationLowerBound<remove_cv_t<T>>(array.data(), ssize(array), key);
+  }
+
+  template <typename T, size_t N>
+  ptrdiff_t interpolationSearch(span<T, N> array, const remove_cv_t<T> key) {
+    return interpolationSearch<remove_cv_t<T>>(array.data(), ssize(array), key);
+  }
+
+  template <typename T, size_t N>
+  ptrdiff_t exponentialLowerBound(span<T, N> array, const remove_cv_t<T> key,
+                                  const ptrdiff_t hint = 0) {
+    return exponentialLowerBound<remove_cv_t<T>>(array.data(), ssize(array), key, hint);
+  }
+
+  template <typename T, size_t N>
+  ptrdiff_t exponentialSearch(span<T, N> array, const remove_cv_t<T> key,
+                              const ptrdiff_t hint = 0) {
+    return exponentialSearch<remove_cv_t<T>>(array.data(), ssize(array), key, hint);
+  }
+
+  // *results* must be at least as long as *keys*
+  template <typename T, size_t N, typename K, size_t M, size_t R>
+  void batchBinarySearch(span<T, N> array, span<K, M> keys, span<ptrdiff_t, R> results) {
+    batchBinarySearch<remove_cv_t<T>>(array.data(), ssize(array), keys.data(), ssize(keys),
+                                      results.data());
+  }
+
+  // A copy of a sorted array in Eytzinger (breadth first) order, where the
+  // children of the element at position k sit at 2k and 2k + 1
+  // The first levels of every search share the same few cache lines, and
+  // the 16 or so great-grandchildren of a position are contiguous, so they
+  // can be prefetched several levels before the search reaches them
+  template <typename T> class EytzingerArray {
+  public:
+    EytzingerArray(const T array[], const ptrdiff_t length)
+        : _keys(length + 1), _indices(length + 1), _length(length) {
+      fill(array, 0, 1);
+    }
+
+    ptrdiff_t count() const { return _length; }
+
+    // Location in the original array of the first element that is not
+    // less than *key* (count() if there is none), as lowerBound() gives
+    ptrdiff_t lowerBound(const T key) const {
+      ptrdiff_t k = lowerBoundPosition(key);
+      return k == 0 ? _length : _indices[k];
+    }
+
+    // Location in the original array of the first occurrence of *key*,
+    // or -1 if it is never found, as binarySearch() gives
+    ptrdiff_t search(const T key) const {
+      ptrdiff_t k = lowerBoundPosition(key);
+      return (k != 0 && _keys[k] == key) ? _indices[k] : -1;
+    }
+
+  private:
+    // Position in _keys of the first element not less than *key*, or 0
+    ptrdiff_t lowerBoundPosition(const T key) const {
+      ptrdiff_t k = 1;
+      while (k <= _length) {
+        prefetch(_keys.data() + k * PREFETCH_STRIDE);
+        k = 2 * k + (_keys[k] < key);
+      }
+      // every step right added a 1 bit; dropping those and the last step
+      // left leads back to where the search last went left
+      return k >> (countr_one(static_cast<size_t>(k)) + 1);
+    }
+
+    // Positions PREFETCH_STRIDE * k onward hold the descendants of k a
+    // few levels down, which fill about one cache line
+    static const int PREFETCH_STRIDE = 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;
+
+    // Place array[i], array[i + 1], ... in order into the subtree rooted at
+    // *k*, returning the index of the next element to place
+    ptrdiff_t fill(const T array[], ptrdiff_t i, const ptrdiff_t k) {
+      if (k <= _length) {
+        i = fill(array, i, 2 * k);
+        _keys[k] = array[i];
+        _indices[k] = i;
+        i = fill(array, i + 1, 2 * k + 1);
+      }
+      return i;
+    }
+
+    vector<T> _keys;             // the elements in breadth first order from position 1
+    vector<ptrdiff_t> _indices;  // where each of _keys was in the original array
+    ptrdiff_t _length;           // number of elements
+  };
 }  // namespace csi281
 
 #endif /* search_hpp */
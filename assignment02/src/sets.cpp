@@ -0,0 +1,129 @@
+//
+//  sets.cpp
+//
+//  Vectorized intersection of sorted int arrays with SSE2 or AVX2, picked
+//  at run time from the instruction sets the CPU supports.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#include "sets.h"
+
+#include <bit>  // for countr_zero()
+
+#include "simd.h"
+
+using namespace std;
+
+namespace csi281 {
+
+#ifdef CSI281_X86
+  // Append the elements of *block* whose bits are set in *mask* to *out*
+  static ptrdiff_t keepMatches(const int block[], unsigned mask, int out[]) {
+    ptrdiff_t count = 0;
+    while (mask != 0) {
+      out[count++] = block[countr_zero(mask)];
+      mask &= mask - 1;
+    }
+    return count;
+  }
+
+  // As no value repeats, a block can only match elements of the other
+  // array's blocks that overlap its range, and advancing the block with
+  // the smaller last element (both when they tie) visits every such pair.
+  // The merge at the end may see elements of a block that already
+  // matched, but they are all less than what is left of the other array
+
+  CSI281_TARGET("sse2")
+  static ptrdiff_t intersectSse2(const int a[], const ptrdiff_t aLength, const int b[],
+                                 const ptrdiff_t bLength, int out[]) {
+    ptrdiff_t i = 0, j = 0, count = 0;
+    while (i + 4 <= aLength && j + 4 <= bLength) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+      __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j));
+      // compare x with all 4 rotations of y
+      __m128i equal = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi32(x, y),
+                       _mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(0, 3, 2, 1)))),
+          _mm_or_si128(_mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2))),
+                       _mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(2, 1, 0, 3)))));
+      unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+      count += keepMatches(a + i, mask, out + count);
+      int aLast = a[i + 3], bLast = b[j + 3];
+      i += aLast <= bLast ? 4 : 0;
+      j += bLast <= aLast ? 4 : 0;
+    }
+    return count + mergeIntersection(a + i, aLength - i, b + j, bLength - j, out + count);
+  }
+
+  CSI281_TARGET("avx2")
+  static ptrdiff_t intersectAvx2(const int a[], const ptrdiff_t aLength, const int b[],
+                                 const ptrdiff_t bLength, int out[]) {
+    ptrdiff_t i = 0, j = 0, count = 0;
+    while (i + 8 <= aLength && j + 8 <= bLength) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+      __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+      // the 4 rotations within each 128 bit half of y, and of y with its
+      // halves swapped, pair every element of x with every element of y
+      __m256i swapped = _mm256_permute2x128_si256(y, y, 1);
+      __m256i equal = _mm256_setzero_si256();
+      for (__m256i z : {y, swapped}) {
+        equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(x, z));
+        equal = _mm256_or_si256(
+            equal, _mm256_cmpeq_epi32(x, _mm256_shuffle_epi32(z, _MM_SHUFFLE(0, 3, 2, 1))));
+        equal = _mm256_or_si256(
+            equal, _mm256_cmpeq_epi32(x, _mm256_shuffle_epi32(z, _MM_SHUFFLE(1, 0, 3, 2))));
+        equal = _mm256_or_si256(
+            equal, _mm256_cmpeq_epi32(x, _mm256_shuffle_epi32(z, _MM_SHUFFLE(2, 1, 0, 3))));
+      }
+      unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+      count += keepMatches(a + i, mask, out + count);
+      int aLast = a[i + 7], bLast = b[j + 7];
+      i += aLast <= bLast ? 8 : 0;
+      j += bLast <= aLast ? 8 : 0;
+    }
+    return count + mergeIntersection(a + i, aLength - i, b + j, bLength - j, out + count);
+  }
+#endif
+
+  ptrdiff_t simdIntersectionWith(SearchIsa isa, const int a[], const ptrdiff_t aLength,
+                                 const int b[], const ptrdiff_t bLength, int out[]) {
+    if (isa > bestSearchIsa()) {
+      isa = bestSearchIsa();
+    }
+    switch (isa) {
+#ifdef CSI281_X86
+      case SearchIsa::AVX512:  // no wider kernel; the AVX2 one still applies
+      case SearchIsa::AVX2:
+        return intersectAvx2(a, aLength, b, bLength, out);
+      case SearchIsa::SSE2:
+        return intersectSse2(a, aLength, b, bLength, out);
+#endif
+      default:
+        return mergeIntersection(a, aLength, b, bLength, out);
+    }
+  }
+
+  ptrdiff_t simdIntersection(const int a[], const ptrdiff_t aLength, const int b[],
+                             const ptrdiff_t bLength, int out[]) {
+    return simdIntersectionWith(bestSearchIsa(), a, aLength, b, bLength, out);
+  }
+}  // namespace csi281
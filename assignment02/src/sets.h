@@ -0,0 +1,213 @@
+//
+//  sets.h
+//
+//  Intersection and union of sorted arrays, with merging, galloping and
+//  (for ints) vectorized kernels and a heuristic to pick between them.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef sets_hpp
+#define sets_hpp
+
+#include <algorithm>  // for copy()
+#include <cstddef>    // for ptrdiff_t
+#include <iterator>   // for ssize()
+#include <span>
+#include <type_traits>
+
+#include "MemoryLeakDetector.h"
+#include "search.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // The ways intersection() and setUnion() can combine two arrays
+  enum class SetStrategy { MERGE, GALLOP, SIMD };
+
+  // When the larger array is at least this many times the length of the
+  // smaller, searching it for each element of the smaller beats merging
+  // (measured on arrays of a million ints)
+  const int GALLOP_RATIO = 8;
+  // The same for int intersections, where blocks of vector compares take
+  // the place of the merge; they skip through the larger array so quickly
+  // that galloping only wins at far more lopsided sizes
+  const int SIMD_GALLOP_RATIO = 128;
+
+  // All of the functions below take sorted arrays with no duplicates (such
+  // as lists of IDs), write the result to *out* in sorted order and return
+  // its length. *out* must have room for the shorter input (intersections)
+  // or both inputs together (unions), and must not overlap either input
+
+  // Steps through both arrays together, keeping the elements both have
+  // Every step compares one pair and advances one or both sides by the
+  // result, so there is no hard to predict branch, and each element is
+  // written to *out* before knowing if it is kept
+  template <typename T>
+  ptrdiff_t mergeIntersection(const T a[], const ptrdiff_t aLength, const T b[],
+                              const ptrdiff_t bLength, T out[]) {
+    ptrdiff_t i = 0, j = 0, count = 0;
+    while (i < aLength && j < bLength) {
+      T x = a[i], y = b[j];
+      out[count] = x;
+      count += x == y;
+      i += !(y < x);
+      j += !(x < y);
+    }
+    return count;
+  }
+
+  // Looks up each element of *small* in *large* with exponentialLowerBound()
+  // from where the last one was found, so it takes about
+  // smallLength * 2 log2(largeLength / smallLength) comparisons
+  template <typename T>
+  ptrdiff_t gallopingIntersection(const T small[], const ptrdiff_t smallLength, const T large[],
+                                  const ptrdiff_t largeLength, T out[]) {
+    ptrdiff_t count = 0, position = 0;
+    for (ptrdiff_t i = 0; i < smallLength && position < largeLength; i++) {
+      position = exponentialLowerBound(large, largeLength, small[i], position);
+      if (position < largeLength && large[position] == small[i]) {
+        out[count++] = small[i];
+        position++;
+      }
+    }
+    return count;
+  }
+
+  // Compares a block of 4 (SSE2) or 8 (AVX2) ints of each array against
+  // every rotation of the other block at once, keeps the matches, and
+  // advances the block or blocks with the smaller last element; what is
+  // left after the last whole blocks is merged. With *isa* SCALAR (or on
+  // CPUs without SSE2) it is mergeIntersection(); see sets.cpp
+  ptrdiff_t simdIntersectionWith(SearchIsa isa, const int a[], const ptrdiff_t aLength,
+                                 const int b[], const ptrdiff_t bLength, int out[]);
+
+  // simdIntersectionWith() the widest instruction set the CPU supports
+  ptrdiff_t simdIntersection(const int a[], const ptrdiff_t aLength, const int b[],
+                             const ptrdiff_t bLength, int out[]);
+
+  // Which kernel intersection() uses for arrays of these lengths: for
+  // ints, when the CPU has vector instructions, blocks of vector compares
+  // unless one array is SIMD_GALLOP_RATIO times the other or more; for
+  // everything else a merge unless one is GALLOP_RATIO times the other
+  // Galloping is used past either ratio
+  template <typename T>
+  SetStrategy intersectionStrategy(const ptrdiff_t aLength, const ptrdiff_t bLength) {
+    ptrdiff_t smaller = aLength < bLength ? aLength : bLength;
+    ptrdiff_t larger = aLength < bLength ? bLength : aLength;
+    if (is_same_v<T, int> && bestSearchIsa() != SearchIsa::SCALAR) {
+      return smaller * SIMD_GALLOP_RATIO <= larger ? SetStrategy::GALLOP : SetStrategy::SIMD;
+    }
+    return smaller * GALLOP_RATIO <= larger ? SetStrategy::GALLOP : SetStrategy::MERGE;
+  }
+
+  // The elements in both *a* and *b*, by the kernel intersectionStrategy() picks
+  template <typename T>
+  ptrdiff_t intersection(const T a[], const ptrdiff_t aLength, const T b[], const ptrdiff_t bLength,
+                         T out[]) {
+    switch (intersectionStrategy<T>(aLength, bLength)) {
+      case SetStrategy::GALLOP:
+        return aLength < bLength ? gallopingIntersection(a, aLength, b, bLength, out)
+                                 : gallopingIntersection(b, bLength, a, aLength, out);
+      case SetStrategy::SIMD:
+        if constexpr (is_same_v<T, int>) {
+          return simdIntersection(a, aLength, b, bLength, out);
+        }
+        [[fallthrough]];
+      default:
+        return mergeIntersection(a, aLength, b, bLength, out);
+    }
+  }
+
+  // Steps through both arrays together like mergeIntersection(), writing
+  // the smaller element of each pair (once, if they are equal), then
+  // copies whatever is left of the longer array
+  template <typename T>
+  ptrdiff_t mergeUnion(const T a[], const ptrdiff_t aLength, const T b[], const ptrdiff_t bLength,
+                       T out[]) {
+    ptrdiff_t i = 0, j = 0, count = 0;
+    while (i < aLength && j < bLength) {
+      T x = a[i], y = b[j];
+      bool takeA = !(y < x), takeB = !(x < y);
+      out[count++] = takeA ? x : y;
+      i += takeA;
+      j += takeB;
+    }
+    T *end = copy(a + i, a + aLength, out + count);
+    end = copy(b + j, b + bLength, end);
+    return end - out;
+  }
+
+  // Finds where each element of *small* goes in *large* with
+  // exponentialLowerBound() and copies the run of *large* before it in
+  // one go, so only about smallLength * 2 log2(largeLength / smallLength)
+  // comparisons are made; the copying is unavoidable
+  template <typename T>
+  ptrdiff_t gallopingUnion(const T small[], const ptrdiff_t smallLength, const T large[],
+                           const ptrdiff_t largeLength, T out[]) {
+    T *end = out;
+    ptrdiff_t position = 0;
+    for (ptrdiff_t i = 0; i < smallLength; i++) {
+      ptrdiff_t next = exponentialLowerBound(large, largeLength, small[i], position);
+      end = copy(large + position, large + next, end);
+      *end++ = small[i];
+      position = (next < largeLength && large[next] == small[i]) ? next + 1 : next;
+    }
+    end = copy(large + position, large + largeLength, end);
+    return end - out;
+  }
+
+  // Which kernel setUnion() uses for arrays of these lengths: galloping
+  // when one is GALLOP_RATIO times the other or more, a merge otherwise
+  // Every element of a union is written anyway, so there is no vector
+  // kernel; a merge is already bound by the writes
+  inline SetStrategy unionStrategy(const ptrdiff_t aLength, const ptrdiff_t bLength) {
+    ptrdiff_t smaller = aLength < bLength ? aLength : bLength;
+    ptrdiff_t larger = aLength < bLength ? bLength : aLength;
+    return smaller * GALLOP_RATIO <= larger ? SetStrategy::GALLOP : SetStrategy::MERGE;
+  }
+
+  // The elements in *a*, *b* or both, by the kernel unionStrategy() picks
+  template <typename T>
+  ptrdiff_t setUnion(const T a[], const ptrdiff_t aLength, const T b[], const ptrdiff_t bLength,
+                     T out[]) {
+    if (unionStrategy(aLength, bLength) == SetStrategy::GALLOP) {
+      return aLength < bLength ? gallopingUnion(a, aLength, b, bLength, out)
+                               : gallopingUnion(b, bLength, a, aLength, out);
+    }
+    return mergeUnion(a, aLength, b, bLength, out);
+  }
+
+  // intersection() and setUnion() for std::span inputs and output; *out*
+  // must be long enough, as above
+  template <typename A, size_t N, typename B, size_t M, typename T, size_t R>
+  ptrdiff_t intersection(span<A, N> a, span<B, M> b, span<T, R> out) {
+    return intersection<T>(a.data(), ssize(a), b.data(), ssize(b), out.data());
+  }
+
+  template <typename A, size_t N, typename B, size_t M, typename T, size_t R>
+  ptrdiff_t setUnion(span<A, N> a, span<B, M> b, span<T, R> out) {
+    return setUnion<T>(a.data(), ssize(a), b.data(), ssize(b), out.data());
+  }
+}  // namespace csi281
+
+#endif /* sets_hpp */
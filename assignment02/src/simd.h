@@ -0,0 +1,47 @@
+//
+//  simd.h
+//
+//  Detection of x86 vector instruction sets at compile time, shared by
+//  the source files that have vectorized kernels.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef simd_hpp
+#define simd_hpp
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#  define CSI281_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>  // for __cpuid(), __cpuidex()
+#  endif
+#endif
+
+// GCC and Clang only emit instructions beyond the compiler's baseline in
+// functions marked for them; MSVC emits any intrinsic anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#  define CSI281_TARGET(isa) __attribute__((target(isa)))
+#else
+#  define CSI281_TARGET(isa)
+#endif
+
+#endif /* simd_hpp */
@@ -32,7 +32,17 @@
 #define TEST_CASE(name, tags) DOCTEST_TEST_CASE(tags " " name)
 using doctest::Approx;
 
+#include <algorithm>  // for sort(), lower_bound(), set_intersection()
+#include <iterator>   // for back_inserter()
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "DataGenerator.h"
+#include "StaticBTree.h"
 #include "search.h"
+#include "sets.h"
 #include "util.h"
 
 // using namespace std;
@@ -153,3 +163,482 @@ TEST_CASE("Array Search Speed", "[Speed]") {
     REQUIRE(speeds.first.count() > speeds.second.count());
   }
 }
+
+TEST_CASE("Branchless and Eytzinger Search", "[Layout]") {
+  const int N = 1000;
+  int *sorted = randomIntArray(N, 0, 2 * N);
+  std::sort(sorted, sorted + N);
+
+  SECTION("Lower bound matches the standard library") {
+    for (int key = -1; key <= 2 * N + 1; key++) {
+      REQUIRE(lowerBound(sorted, N, key) == std::lower_bound(sorted, sorted + N, key) - sorted);
+    }
+    int empty[1] = {0};
+    REQUIRE(lowerBound(empty, 0, 5) == 0);
+  }
+
+  SECTION("Found keys match binarySearch()") {
+    int unique[6] = {2, 3, 5, 7, 11, 13};
+    EytzingerArray<int> tree(unique, 6);
+    for (int key = 0; key <= 14; key++) {
+      REQUIRE(branchlessBinarySearch(unique, 6, key) == binarySearch(unique, 6, key));
+      REQUIRE(tree.search(key) == binarySearch(unique, 6, key));
+    }
+  }
+
+  SECTION("Eytzinger order gives the first location") {
+    EytzingerArray<int> tree(sorted, N);
+    for (int key = -1; key <= 2 * N + 1; key++) {
+      int first = branchlessBinarySearch(sorted, N, key);
+      REQUIRE(tree.search(key) == first);
+      REQUIRE(tree.lowerBound(key) == lowerBound(sorted, N, key));
+      if (first != -1) {
+        REQUIRE(sorted[first] == key);
+        REQUIRE((first == 0 || sorted[first - 1] < key));
+      }
+    }
+  }
+
+  SECTION("float and char keys") {
+    float floats[4] = {2.1f, 4.0f, 11.5f, 17.1f};
+    REQUIRE(branchlessBinarySearch(floats, 4, 11.5f) == 2);
+    REQUIRE(EytzingerArray<float>(floats, 4).search(17.1f) == 3);
+    char chars[4] = {'a', 'c', 'f', 'r'};
+    REQUIRE(EytzingerArray<char>(chars, 4).search('b') == -1);
+  }
+
+  delete[] sorted;
+}
+
+TEST_CASE("Vectorized Linear Search", "[SIMD]") {
+  const SearchIsa isas[4] = {SearchIsa::SCALAR, SearchIsa::SSE2, SearchIsa::AVX2,
+                             SearchIsa::AVX512};
+  const int N = 67;  // not a multiple of any vector width, to exercise the tail
+  int ints[N];
+  float floats[N];
+  double doubles[N];
+  for (int i = 0; i < N; i++) {
+    ints[i] = i * 3;
+    floats[i] = i * 0.5f;
+    doubles[i] = i * 0.25;
+  }
+  ints[40] = 3;  // a repeat of ints[1]
+
+  SECTION("Every position with every instruction set") {
+    for (SearchIsa isa : isas) {
+      for (int i = 0; i < N; i++) {
+        if (i != 40) {
+          REQUIRE(linearSearchWith(isa, ints, N, i * 3) == i);
+        }
+        REQUIRE(linearSearchWith(isa, floats, N, i * 0.5f) == i);
+        REQUIRE(linearSearchWith(isa, doubles, N, i * 0.25) == i);
+      }
+      REQUIRE(linearSearchWith(isa, ints, N, 3) == 1);
+      REQUIRE(linearSearchWith(isa, ints, N, -1) == -1);
+      REQUIRE(linearSearchWith(isa, floats, N, 0.3f) == -1);
+      REQUIRE(linearSearchWith(isa, doubles, 0, 0.0) == -1);
+    }
+  }
+
+  SECTION("Matches the scalar template") {
+    for (int i = -1; i <= N * 3; i++) {
+      REQUIRE(linearSearch(ints, N, i) == linearSearchWith(SearchIsa::SCALAR, ints, N, i));
+    }
+  }
+
+  SECTION("Float equality as with ==") {
+    floats[5] = -0.0f;
+    REQUIRE(linearSearch(floats, N, 0.0f) == 0);
+    REQUIRE(linearSearch(floats, N, std::numeric_limits<float>::quiet_NaN()) == -1);
+    doubles[50] = std::numeric_limits<double>::quiet_NaN();
+    REQUIRE(linearSearch(doubles, N, std::numeric_limits<double>::quiet_NaN()) == -1);
+  }
+}
+
+TEST_CASE("Batched Binary Search", "[Batch]") {
+  const int N = 5000;
+  const int NUM_KEYS = 1003;  // not a multiple of the group size
+  int *sorted = randomIntArray(N, 0, 2 * N);
+  std::sort(sorted, sorted + N);
+  int *keys = randomIntArray(NUM_KEYS, -10, 2 * N + 10);
+  ptrdiff_t *results = new ptrdiff_t[NUM_KEYS];
+
+  SECTION("Same answers as one search at a time") {
+    batchBinarySearch(sorted, N, keys, NUM_KEYS, results);
+    for (int i = 0; i < NUM_KEYS; i++) {
+      REQUIRE(results[i] == branchlessBinarySearch(sorted, N, keys[i]));
+    }
+  }
+
+  SECTION("Small and empty arrays") {
+    char chars[4] = {'a', 'c', 'f', 'r'};
+    char charKeys[5] = {'r', 'a', 'b', 'f', 'z'};
+    ptrdiff_t charResults[5];
+    batchBinarySearch(chars, 4, charKeys, 5, charResults);
+    REQUIRE(charResults[0] == 3);
+    REQUIRE(charResults[1] == 0);
+    REQUIRE(charResults[2] == -1);
+    REQUIRE(charResults[3] == 2);
+    REQUIRE(charResults[4] == -1);
+
+    batchBinarySearch(sorted, 0, keys, NUM_KEYS, results);
+    REQUIRE(results[NUM_KEYS - 1] == -1);
+  }
+
+  delete[] sorted;
+  delete[] keys;
+  delete[] results;
+}
+
+TEST_CASE("Static B-Tree", "[BTree]") {
+  SECTION("Matches lowerBound() and binarySearch() at every size") {
+    // one leaf, a partial leaf, a full root, and three levels with partial nodes
+    const int sizes[] = {0, 1, 15, 16, 17, 16 * 17, 16 * 17 + 5, 5000};
+    for (int n : sizes) {
+      int *sorted = randomIntArray(n, 0, n);  // plenty of duplicates
+      std::sort(sorted, sorted + n);
+      StaticBTree tree(sorted, n);
+      REQUIRE(tree.count() == n);
+      for (int key = -2; key <= n + 2; key++) {
+        REQUIRE(tree.lowerBound(key) == lowerBound(sorted, n, key));
+        REQUIRE(tree.find(key) == branchlessBinarySearch(sorted, n, key));
+      }
+      delete[] sorted;
+    }
+  }
+
+  SECTION("Extreme keys") {
+    int extremes[5] = {std::numeric_limits<int>::min(), -1, 0, 7,
+                       std::numeric_limits<int>::max()};
+    StaticBTree tree(extremes, 5);
+    REQUIRE(tree.find(std::numeric_limits<int>::min()) == 0);
+    REQUIRE(tree.find(std::numeric_limits<int>::max()) == 4);
+    REQUIRE(tree.find(8) == -1);
+    REQUIRE(tree.lowerBound(8) == 4);
+  }
+
+  SECTION("Same answers as binarySearch() for unique keys") {
+    int unique[7] = {5, 45, 112, 422, 743, 45234, 822342};
+    StaticBTree tree(unique, 7);
+    for (int key : {5, 72, 422, 822342, 345}) {
+      REQUIRE(tree.find(key) == binarySearch(unique, 7, key));
+    }
+  }
+}
+
+TEST_CASE("Learned Index", "[Learned]") {
+  SECTION("Uniform keys need few segments") {
+    const int N = 10000;
+    int *sorted = randomIntArray(N, 0, 10 * N);
+    std::sort(sorted, sorted + N);
+    LearnedIndex<int> index(sorted, N);
+    REQUIRE(index.count() == N);
+    REQUIRE(index.segmentCount() < N / 100);
+    for (int key = -5; key <= 10 * N + 5; key++) {
+      REQUIRE(index.lowerBound(key) == lowerBound(sorted, N, key));
+    }
+    delete[] sorted;
+  }
+
+  SECTION("Skewed keys with duplicates") {
+    const int N = 4000;
+    int *sorted = new int[N];
+    for (int i = 0; i < N; i++) {
+      sorted[i] = (i / 3) * (i / 3) / 7;  // quadratic growth, runs of repeats
+    }
+    LearnedIndex<int> index(sorted, N, 8);
+    for (int key = -1; key <= sorted[N - 1] + 1; key += 3) {
+      REQUIRE(index.lowerBound(key) == lowerBound(sorted, N, key));
+      REQUIRE(index.search(key) == branchlessBinarySearch(sorted, N, key));
+    }
+    delete[] sorted;
+  }
+
+  SECTION("Small arrays and other types") {
+    int unique[7] = {5, 45, 112, 422, 743, 45234, 822342};
+    LearnedIndex<int> ints(unique, 7, 1);
+    for (int key : {5, 72, 422, 822342, 345, 1000000}) {
+      REQUIRE(ints.search(key) == binarySearch(unique, 7, key));
+    }
+    double doubles[4] = {-1.5, 0.25, 0.5, 1e9};
+    LearnedIndex<double> reals(doubles, 4);
+    REQUIRE(reals.search(0.5) == 2);
+    REQUIRE(reals.lowerBound(2.0) == 3);
+    LearnedIndex<int> empty(unique, 0);
+    REQUIRE(empty.search(5) == -1);
+    REQUIRE(empty.lowerBound(5) == 0);
+  }
+}
+
+TEST_CASE("Interpolation and Exponential Search", "[Adaptive]") {
+  const int N = 3000;
+  int *uniform = randomIntArray(N, 0, 4 * N);
+  std::sort(uniform, uniform + N);
+  int *skewed = new int[N];
+  for (int i = 0; i < N; i++) {
+    // cubic growth with repeats
+    skewed[i] = static_cast<int>(static_cast<long long>(i / 2) * (i / 2) * (i / 2) / 1000);
+  }
+
+  SECTION("Interpolation matches lowerBound()") {
+    for (int key = -3; key <= 4 * N + 3; key++) {
+      REQUIRE(interpolationLowerBound(uniform, N, key) == lowerBound(uniform, N, key));
+    }
+    for (int key = -1; key <= skewed[N - 1] + 1; key += 97) {
+      REQUIRE(interpolationLowerBound(skewed, N, key) == lowerBound(skewed, N, key));
+    }
+    double reals[5] = {0.5, 0.5, 2.25, 9.0, 1e12};
+    REQUIRE(interpolationSearch(reals, 5, 0.5) == 0);
+    REQUIRE(interpolationSearch(reals, 5, 9.0) == 3);
+    REQUIRE(interpolationSearch(reals, 5, 3.0) == -1);
+    REQUIRE(interpolationSearch(reals, 0, 3.0) == -1);
+  }
+
+  SECTION("Exponential search from any hint") {
+    for (int hint : {-5, 0, 1, N / 3, N - 1, N + 10}) {
+      for (int key = -3; key <= 4 * N + 3; key += 7) {
+        REQUIRE(exponentialLowerBound(uniform, N, key, hint) == lowerBound(uniform, N, key));
+        REQUIRE(exponentialSearch(uniform, N, key, hint)
+                == branchlessBinarySearch(uniform, N, key));
+      }
+    }
+    int unique[7] = {5, 45, 112, 422, 743, 45234, 822342};
+    REQUIRE(exponentialSearch(unique, 7, 743) == binarySearch(unique, 7, 743));
+    REQUIRE(exponentialSearch(unique, 0, 743) == -1);
+  }
+
+  SECTION("Strategy follows the data") {
+    REQUIRE(AdaptiveSearch<int>(uniform, N).strategy() == SearchStrategy::INTERPOLATION);
+    REQUIRE(AdaptiveSearch<int>(skewed, N).strategy() == SearchStrategy::BINARY);
+    REQUIRE(AdaptiveSearch<int>(uniform, 20).strategy() == SearchStrategy::LINEAR);
+    char chars[4] = {'a', 'c', 'f', 'r'};
+    REQUIRE(AdaptiveSearch<char>(chars, 4).search('f') == 2);
+  }
+
+  SECTION("Every strategy gives the same answers") {
+    for (int *array : {uniform, skewed}) {
+      for (int length : {0, 20, N}) {
+        AdaptiveSearch<int> search(array, length);
+        for (int key = -1; key <= array[N - 1] + 1; key += 11) {
+          REQUIRE(search.lowerBound(key) == lowerBound(array, length, key));
+          REQUIRE(search.search(key, length / 2) == branchlessBinarySearch(array, length, key));
+        }
+      }
+    }
+  }
+
+  delete[] uniform;
+  delete[] skewed;
+}
+
+TEST_CASE("Seeded Data Generator", "[DataGen]") {
+  const int N = 10000;
+  const int MIN = -500;
+  const int MAX = 1500;
+  const Distribution all[] = {Distribution::UNIFORM,  Distribution::ZIPFIAN,
+                              Distribution::SORTED,   Distribution::REVERSED,
+                              Distribution::FEW_UNIQUE, Distribution::CLUSTERED};
+
+  SECTION("Same seed, same data") {
+    for (Distribution distribution : all) {
+      DataGenerator first(42), second(42), other(43);
+      int *a = first.generate(N, MIN, MAX, distribution);
+      int *b = second.generate(N, MIN, MAX, distribution);
+      int *c = other.generate(N, MIN, MAX, distribution);
+      REQUIRE(equal(a, a + N, b));
+      REQUIRE_FALSE(equal(a, a + N, c));
+      delete[] a;
+      delete[] b;
+      delete[] c;
+    }
+  }
+
+  SECTION("Everything in range") {
+    DataGenerator generator;
+    for (Distribution distribution : all) {
+      int *array = generator.generate(N, MIN, MAX, distribution);
+      REQUIRE(*min_element(array, array + N) >= MIN);
+      REQUIRE(*max_element(array, array + N) <= MAX);
+      delete[] array;
+    }
+    int full[1000];
+    generator.fill(full, 1000, numeric_limits<int>::min(), numeric_limits<int>::max(),
+                   Distribution::SORTED);
+    REQUIRE(is_sorted(full, full + 1000));
+    REQUIRE(generator.next(7, 7) == 7);
+  }
+
+  SECTION("Shapes") {
+    DataGenerator generator;
+    int *sorted = generator.generate(N, MIN, MAX, Distribution::SORTED);
+    REQUIRE(is_sorted(sorted, sorted + N));
+    // spread over the range, not piled at one end
+    REQUIRE(sorted[N / 2] > MIN + 800);
+    REQUIRE(sorted[N / 2] < MAX - 800);
+
+    int *reversed = generator.generate(N, MIN, MAX, Distribution::REVERSED);
+    REQUIRE(is_sorted(reversed, reversed + N, greater<int>()));
+
+    int *few = generator.generate(N, MIN, MAX, Distribution::FEW_UNIQUE);
+    sort(few, few + N);
+    REQUIRE(unique(few, few + N) - few <= DataGenerator::FEW_UNIQUE_VALUES);
+
+    // the most popular value should dominate a Zipfian sample
+    int *zipf = generator.generate(N, MIN, MAX, Distribution::ZIPFIAN);
+    int atMin = static_cast<int>(count(zipf, zipf + N, MIN));
+    REQUIRE(atMin > N / 20);
+    REQUIRE(count(zipf, zipf + N, MIN + 1000) < atMin / 10);
+
+    delete[] sorted;
+    delete[] reversed;
+    delete[] few;
+    delete[] zipf;
+  }
+
+  SECTION("Zipfian over the whole int range") {
+    // the normalizing sum is estimated past a cutoff instead of taking
+    // billions of terms
+    DataGenerator generator;
+    int *zipf = generator.generate(N, numeric_limits<int>::min(), numeric_limits<int>::max(),
+                                   Distribution::ZIPFIAN);
+    int atMin = static_cast<int>(count(zipf, zipf + N, numeric_limits<int>::min()));
+    REQUIRE(atMin > N / 50);
+    REQUIRE(atMin < N / 10);
+    delete[] zipf;
+  }
+}
+
+TEST_CASE("Sorted Set Intersection and Union", "[Sets]") {
+  DataGenerator generator(19);
+  // sorted ints without duplicates, about *length* of them
+  auto idList = [&generator](vector<int> &ids, const int length, const int max) {
+    ids.resize(length);
+    generator.fill(ids.data(), length, 0, max, Distribution::SORTED);
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+  };
+  const int lengths[] = {0, 1, 3, 7, 8, 9, 31, 100, 1000, 5000};
+  const int maxes[] = {10, 3000, 100000};
+
+  SECTION("Every kernel matches the standard library") {
+    vector<int> a, b, expected, out;
+    for (int aLength : lengths) {
+      for (int bLength : lengths) {
+        for (int max : maxes) {
+          idList(a, aLength, max);
+          idList(b, bLength, max);
+          int aSize = static_cast<int>(a.size()), bSize = static_cast<int>(b.size());
+
+          expected.clear();
+          set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected));
+          out.assign(aSize + bSize + 1, -1);
+          REQUIRE(mergeIntersection(a.data(), aSize, b.data(), bSize, out.data())
+                  == static_cast<int>(expected.size()));
+          REQUIRE(equal(expected.begin(), expected.end(), out.begin()));
+          for (SearchIsa isa : {SearchIsa::SCALAR, SearchIsa::SSE2, SearchIsa::AVX2}) {
+            out.assign(aSize + bSize + 1, -1);
+            REQUIRE(simdIntersectionWith(isa, a.data(), aSize, b.data(), bSize, out.data())
+                    == static_cast<int>(expected.size()));
+            REQUIRE(equal(expected.begin(), expected.end(), out.begin()));
+          }
+          out.assign(aSize + bSize + 1, -1);
+          REQUIRE(gallopingIntersection(a.data(), aSize, b.data(), bSize, out.data())
+                  == static_cast<int>(expected.size()));
+          REQUIRE(equal(expected.begin(), expected.end(), out.begin()));
+          out.assign(aSize + bSize + 1, -1);
+          REQUIRE(intersection(a.data(), aSize, b.data(), bSize, out.data())
+                  == static_cast<int>(expected.size()));
+          REQUIRE(equal(expected.begin(), expected.end(), out.begin()));
+
+          expected.clear();
+          set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected));
+          out.assign(aSize + bSize + 1, -1);
+          REQUIRE(mergeUnion(a.data(), aSize, b.data(), bSize, out.data())
+                  == static_cast<int>(expected.size()));
+          REQUIRE(equal(expected.begin(), expected.end(), out.begin()));
+          out.assign(aSize + bSize + 1, -1);
+          REQUIRE(gallopingUnion(a.data(), aSize, b.data(), bSize, out.data())
+                  == static_cast<int>(expected.size()));
+          REQUIRE(equal(expected.begin(), expected.end(), out.begin()));
+          out.assign(aSize + bSize + 1, -1);
+          REQUIRE(setUnion(a.data(), aSize, b.data(), bSize, out.data())
+                  == static_cast<int>(expected.size()));
+          REQUIRE(equal(expected.begin(), expected.end(), out.begin()));
+        }
+      }
+    }
+  }
+
+  SECTION("Strategy follows the sizes") {
+    REQUIRE(intersectionStrategy<int>(10, 10 * SIMD_GALLOP_RATIO) == SetStrategy::GALLOP);
+    REQUIRE(intersectionStrategy<int>(10 * SIMD_GALLOP_RATIO, 10) == SetStrategy::GALLOP);
+    REQUIRE(intersectionStrategy<double>(1000, 2000) == SetStrategy::MERGE);
+    REQUIRE(intersectionStrategy<double>(10, 10 * GALLOP_RATIO) == SetStrategy::GALLOP);
+    REQUIRE(intersectionStrategy<int>(1000, 2000)
+            == (bestSearchIsa() == SearchIsa::SCALAR ? SetStrategy::MERGE : SetStrategy::SIMD));
+    REQUIRE(unionStrategy(1000, 2000) == SetStrategy::MERGE);
+    REQUIRE(unionStrategy(1000, 1000 * GALLOP_RATIO) == SetStrategy::GALLOP);
+  }
+
+  SECTION("Other element types") {
+    double a[5] = {-1.5, 0.0, 2.25, 3.0, 9.0};
+    double b[4] = {0.0, 3.0, 4.0, 9.0};
+    double out[9];
+    REQUIRE(intersection(a, 5, b, 4, out) == 3);
+    REQUIRE(out[0] == 0.0);
+    REQUIRE(out[2] == 9.0);
+    REQUIRE(setUnion(a, 5, b, 4, out) == 6);
+    REQUIRE(out[4] == 4.0);
+  }
+}
+
+TEST_CASE("Span Overloads and 64-bit Locations", "[Span]") {
+  vector<int> sorted(3000);
+  sharedGenerator().fill(sorted.data(), 3000, 0, 9000, Distribution::SORTED);
+  span<const int> whole(sorted);
+
+  SECTION("Same answers as pointer and length") {
+    for (int key = -2; key <= 9002; key += 5) {
+      REQUIRE(linearSearch(whole, key) == linearSearch(sorted.data(), 3000, key));
+      REQUIRE(lowerBound(whole, key) == lowerBound(sorted.data(), 3000, key));
+      REQUIRE(branchlessBinarySearch(whole, key)
+              == branchlessBinarySearch(sorted.data(), 3000, key));
+      REQUIRE(interpolationLowerBound(whole, key) == lowerBound(sorted.data(), 3000, key));
+      REQUIRE(exponentialLowerBound(whole, key, 1500) == lowerBound(sorted.data(), 3000, key));
+      REQUIRE(exponentialSearch(span(sorted), key) == branchlessBinarySearch(whole, key));
+      REQUIRE(interpolationSearch(whole, key) == branchlessBinarySearch(whole, key));
+    }
+    int unique[7] = {5, 45, 112, 422, 743, 45234, 822342};
+    REQUIRE(binarySearch(span(unique), 743) == 4);
+    REQUIRE(binarySearch(span(unique).subspan(2), 743) == 2);
+
+    vector<ptrdiff_t> results(4);
+    int keys[4] = {5, 6, 822342, 112};
+    batchBinarySearch(span(unique), span(keys), span(results));
+    REQUIRE(results == vector<ptrdiff_t>{0, -1, 6, 2});
+
+    int evens[5] = {0, 2, 4, 6, 8}, out[12];
+    REQUIRE(intersection(span(unique), span(evens), span(out)) == 0);
+    REQUIRE(setUnion(span(unique), span(evens), span(out)) == 12);
+    REQUIRE(out[3] == 5);
+  }
+
+  SECTION("Empty spans") {
+    span<const int> none;
+    span<const int> emptyTail = whole.subspan(3000);
+    for (span<const int> empty : {none, emptyTail}) {
+      REQUIRE(binarySearch(empty, 5) == -1);
+      REQUIRE(linearSearch(empty, 5) == -1);
+      REQUIRE(branchlessBinarySearch(empty, 5) == -1);
+      REQUIRE(lowerBound(empty, 5) == 0);
+      REQUIRE(interpolationLowerBound(empty, 5) == 0);
+      REQUIRE(exponentialSearch(empty, 5) == -1);
+      REQUIRE(interpolationSearch(empty, 5) == -1);
+    }
+  }
+
+  SECTION("Locations are ptrdiff_t") {
+    REQUIRE(is_same_v<decltype(lowerBound(whole, 0)), ptrdiff_t>);
+    REQUIRE(is_same_v<decltype(linearSearch(sorted.data(), 3000, 0)), ptrdiff_t>);
+    REQUIRE(is_same_v<decltype(AdaptiveSearch<int>(sorted.data(), 3000).search(0)), ptrdiff_t>);
+  }
+}
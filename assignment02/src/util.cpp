@@ -28,10 +28,13 @@
 #include "util.h"
 
 #include <algorithm>
+#include <cmath>  // for pow()
 #include <iostream>
-#include <random>
+#include <vector>
 
+#include "DataGenerator.h"
 #include "search.h"
+#include "simd.h"
 
 using namespace std;
 
@@ -39,98 +42,150 @@ namespace csi281 {
 
   // Returns a new int array of *length* and filled
   // with numbers between *min* and *max*
-  // Suggest using the facilities in STL <random>
+  // The numbers come from the shared seeded generator, so that
+  // every run of the timings sees the same data
   int *randomIntArray(const int length, const int min, const int max) {
-    // random device
-    std::random_device rd;
-
-    std::mt19937 generator(rd()); // Mersenne Twister RNG
-    std::uniform_int_distribution<int> distribution(min, max);
-    // int r = distribution(generator); // use the distribution to transform the random number
-    // int r2 = distribution(rd); // use the rd to get a random element in the distribution range
-
-    int *array = new int[length];
-    for (int i = 0; i < length; i++)
-    {
-      array[i] = distribution(rd);
+    return sharedGenerator().generate(length, min, max);
+  }
+
+  // Searches in the warmup before the timed samples, which brings the
+  // code and (for a hot cache) the array into the caches and trains the
+  // branch predictor
+  static const int WARMUP_SEARCHES = 100;
+  // With a hot cache one search is too quick for the clock to time on its
+  // own, so each sample times this many and keeps the time per search
+  static const int HOT_BATCH = 16;
+  // Bytes written to push an array out of the caches where it can not be
+  // flushed directly; larger than the last level cache of most machines
+  static const size_t EVICTION_BYTES = 64 << 20;
+
+  // Remove the *bytes* bytes at *data* from every level of cache
+  static void evictFromCache(const void *data, const size_t bytes) {
+#ifdef CSI281_X86
+    if (bytes == 0) {
+      return;
+    }
+    const char *start = static_cast<const char *>(data);
+    for (size_t offset = 0; offset < bytes; offset += 64) {
+      _mm_clflush(start + offset);
+    }
+    _mm_clflush(start + bytes - 1);
+    _mm_mfence();
+#else
+    // without a flush instruction, fill the caches with something else
+    static vector<char> eviction(EVICTION_BYTES);
+    for (size_t i = 0; i < eviction.size(); i += 64) {
+      eviction[i]++;
+    }
+    doNotOptimize(eviction[0]);
+    (void)data;
+    (void)bytes;
+#endif
+  }
+
+  // Time *numSamples* samples of *search*, a function of one key, over the
+  // *numKeys* *keys* after a warmup
+  // With a hot cache each sample is a batch of HOT_BATCH back to back
+  // searches; with a cold cache it is one search right after the *bytes*
+  // bytes at *data* that the search reads are flushed from the caches
+  template <typename Search>
+  static SearchTiming timeSearches(Search search, const int keys[], const int numKeys,
+                                   const int numSamples, const void *data, const size_t bytes,
+                                   const CacheState cache) {
+    for (int i = 0; i < WARMUP_SEARCHES; i++) {
+      doNotOptimize(search(keys[i % numKeys]));
+    }
+
+    int perSample = cache == CacheState::HOT ? HOT_BATCH : 1;
+    vector<searchtime> samples(numSamples);
+    int next = 0;  // next key to search for
+    for (int s = 0; s < numSamples; s++) {
+      if (cache == CacheState::COLD) {
+        evictFromCache(data, bytes);
+      }
+      auto start = steady_clock::now();
+      for (int i = 0; i < perSample; i++) {
+        doNotOptimize(search(keys[next]));
+        next = (next + 1) % numKeys;
+      }
+      samples[s] = (steady_clock::now() - start) / perSample;
+    }
+
+    searchtime total(0);
+    for (searchtime sample : samples) {
+      total += sample;
     }
-    return array;
+    sort(samples.begin(), samples.end());
+    size_t p99 = (samples.size() * 99 + 99) / 100 - 1;  // the ceiling of 99%, less 1
+    return {samples[samples.size() / 2], samples[p99], numSamples / (total.count() * 1e-9)};
+  }
+
+  // Time linear search of an unsorted random array of *length* ints
+  // against binary search of a sorted copy of it
+  // Both search for the same keys, drawn from the same range as the
+  // array, so some are found (linear search stops early) and some are not
+  // (linear search reads the whole array)
+  SearchBenchmark searchBenchmark(const int length, const int numTests, const CacheState cache) {
+    int *unsortedArray = randomIntArray(length, 0, length);
+    int *sortedArray = new int[length];
+    copy(unsortedArray, unsortedArray + length, sortedArray);
+    sort(sortedArray, sortedArray + length);
+    int *testKeys = randomIntArray(numTests, 0, length);
+    size_t bytes = length * sizeof(int);
+
+    SearchBenchmark result = {length, cache, {}, {}};
+    result.linearSearch = timeSearches(
+        [&](int key) { return linearSearch(unsortedArray, length, key); }, testKeys, numTests,
+        numTests, unsortedArray, bytes, cache);
+    result.binarySearch = timeSearches(
+        [&](int key) { return binarySearch(sortedArray, length, key); }, testKeys, numTests,
+        numTests, sortedArray, bytes, cache);
+
+    delete[] unsortedArray;
+    delete[] sortedArray;
+    delete[] testKeys;
+    return result;
   }
 
   // Finds the speed of linear versus binary search
   // in a random int array of *length* size
-  // by running *numTests* and averaging them
-  // Returns a pair indicating the average time it took
-  // to do linear search and binary search in nanoseconds
-  // Linear search should be first in the pair, and binary search
-  // should be second
-  //
-  // Suggest using the facilities in STL <chrono>
-  // For example, you can start a timer using
-  // using namespace std::chrono;
-  // auto start = duration_cast< nanoseconds >(system_clock::now().time_since_epoch()).count();
-  // and stop a timer using
-  // auto end = duration_cast< nanoseconds >(system_clock::now().time_since_epoch()).count();
-  // start, end will be results in nanoseconds
+  // Returns a pair of the median time of one linear search and one binary
+  // search (of a sorted copy of the array) with a hot cache, each over
+  // *numTests* samples
   pair<nanoseconds, nanoseconds> arraySearchSpeed(const int length, const int numTests) {
-    int *testArray = randomIntArray(length, 0, length);
-    int *testKeys = randomIntArray(numTests, 0, length);
-
-    using namespace std::chrono;
-
-    // Do numTests linear searches and find the average time
-    // Put the result in a variable linearSearchSpeed
+    SearchBenchmark benchmark = searchBenchmark(length, numTests, CacheState::HOT);
+    return pair<nanoseconds, nanoseconds>(duration_cast<nanoseconds>(benchmark.linearSearch.median),
+                                          duration_cast<nanoseconds>(benchmark.binarySearch.median));
+  }
 
-    auto linearSearchSpeed = 0;
-    for (int i = 0; i < numTests; i++) {
-      auto start = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
-      for (int j = 0; j < length; j++) {
-        if (testKeys[i] == testArray[j]) {
-          auto end = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
-          linearSearchSpeed += end - start;
-          break;
-        }
+  // Time binarySearch() against LearnedIndex::search() on the same keys
+  LearnedIndexSpeed learnedIndexSpeed(const int length, const int numTests, const bool skewed) {
+    int *sortedArray = randomIntArray(length, 0, length * 10);
+    if (skewed) {
+      // squash the keys towards 0 so the density changes along the array
+      for (int i = 0; i < length; i++) {
+        sortedArray[i] = static_cast<int>(pow(sortedArray[i] / (length * 10.0), 4) * length * 10);
       }
     }
-    linearSearchSpeed /= numTests;
-
-    // Do numTests binary searches and find the average time
-    // Put the result in a variable binarySearchSpeed
-
-    auto binarySearchSpeed = 0;
+    sort(sortedArray, sortedArray + length);
+    int *testKeys = new int[numTests];
+    int *positions = randomIntArray(numTests, 0, length - 1);
     for (int i = 0; i < numTests; i++) {
-      auto start = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
-
-      int left = 0;
-      int right = length - 1;
-      int middle = (right - left) / 2;
-
-      bool found = false;
-      while (!found) {
-        if (testArray[middle] == testKeys[i]) {
-          auto end = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
-          linearSearchSpeed += end - start;
-          found = true;
-        }
-        else if (left >= right) {
-          auto end = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
-          linearSearchSpeed += end - start;
-          break;
-        }
-        else if (testArray[middle] < testKeys[i]) {
-          left = middle + 1;
-          middle = (right - left) / 2 + left;
-        }
-        else if (testArray[middle] > testKeys[i]) {
-          right = middle - 1;
-          middle = (right - left) / 2 + left;
-        }
-      }
+      testKeys[i] = sortedArray[positions[i]];
     }
 
-    delete testArray;
-    delete testKeys;
-
-    return pair<nanoseconds, nanoseconds>(linearSearchSpeed, binarySearchSpeed);
+    LearnedIndex<int> index(sortedArray, length);
+    size_t bytes = length * sizeof(int);
+    LearnedIndexSpeed result = {
+        timeSearches([&](int key) { return binarySearch(sortedArray, length, key); }, testKeys,
+                     numTests, numTests, sortedArray, bytes, CacheState::HOT),
+        timeSearches([&](int key) { return index.search(key); }, testKeys, numTests, numTests,
+                     sortedArray, bytes, CacheState::HOT),
+        index.segmentCount(), index.modelBytes()};
+
+    delete[] sortedArray;
+    delete[] testKeys;
+    delete[] positions;
+    return result;
   }
 }  // namespace csi281
@@ -29,6 +29,7 @@
 #define util_hpp
 
 #include <chrono>   // for nanoseconds
+#include <cstddef>
 #include <utility>  // for pair
 
 #include "MemoryLeakDetector.h"
@@ -37,8 +38,62 @@ using namespace std;
 using namespace std::chrono;
 
 namespace csi281 {
+  // Keep the compiler from optimizing away the work that produced *value*
+  template <typename T> inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+  }
+
   int *randomIntArray(const int length, const int min, const int max);
+
+  // Whether the searched array is in the CPU caches when a search starts
+  enum class CacheState {
+    HOT,  // searched over and over, so it stays cached
+    COLD  // flushed from every cache before each search
+  };
+
+  // Time of one search, in fractions of a nanosecond
+  using searchtime = duration<double, nano>;
+
+  // How long one search algorithm took over many timed samples
+  struct SearchTiming {
+    searchtime median;    // half of the searches were quicker than this
+    searchtime p99;       // 99% of the searches were quicker than this
+    double opsPerSecond;  // searches per second over all of the samples
+  };
+
+  // Linear search of an unsorted array versus binary search of a sorted
+  // copy of it, both looking for the same random keys
+  struct SearchBenchmark {
+    int length;
+    CacheState cache;
+    SearchTiming linearSearch;
+    SearchTiming binarySearch;
+  };
+
+  // Time *numTests* samples of each search on random arrays of *length*
+  // ints after a warmup; see util.cpp for how samples are taken
+  SearchBenchmark searchBenchmark(const int length, const int numTests, const CacheState cache);
+
+  // Median time of linear and binary search with a hot cache, from searchBenchmark()
   pair<nanoseconds, nanoseconds> arraySearchSpeed(const int length, const int numTests);
+
+  // Result of comparing binarySearch() with a LearnedIndex on one array
+  struct LearnedIndexSpeed {
+    SearchTiming binarySearch;  // timing of binarySearch()
+    SearchTiming learnedIndex;  // timing of LearnedIndex::search()
+    ptrdiff_t segments;         // segments the model needed
+    size_t modelBytes;          // memory taken by the model
+  };
+
+  // Times both ways of searching a sorted array of *length* keys, either
+  // spread uniformly or *skewed* (bunched up towards the small keys), with
+  // *numTests* hot cache samples of searches for keys that are in the array
+  LearnedIndexSpeed learnedIndexSpeed(const int length, const int numTests, const bool skewed);
 }  // namespace csi281
 
 #endif /* util_hpp */
@@ -28,8 +28,12 @@
 #ifndef dynamicarray_hpp
 #define dynamicarray_hpp
 
-#include <algorithm>  // for copy(), min(), move_backward
+#include <algorithm>  // for max(), min(), move(), move_backward()
 #include <cassert>
+#include <memory>       // for uninitialized_move(), uninitialized_copy(), destroy()
+#include <new>          // for placement new
+#include <type_traits>  // for is_nothrow_move_constructible_v
+#include <utility>      // for forward()
 
 #include "Collection.h"
 #include "MemoryLeakDetector.h"
@@ -39,16 +43,40 @@
 using namespace std;
 
 namespace csi281 {
-  template <typename T> class DynamicArray : public Collection<T> {
+  // Room for *N* items of type T inside an object, left unconstructed
+  template <typename T, int N> struct InlineStorage {
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+    T *items() { return reinterpret_cast<T *>(bytes); }
+  };
+
+  // No inline room at all, which takes no space
+  template <typename T> struct InlineStorage<T, 0> {
+    T *items() { return nullptr; }
+  };
+
+  // The backing store is raw memory: only the first *count* slots hold
+  // constructed items, so T needs no default constructor and unused
+  // capacity costs no constructions
+  // The first *INLINE* items live inside the array itself, and the heap
+  // is only used once it grows past them (see SmallDynamicArray below)
+  template <typename T, int INLINE = 0> class DynamicArray : public Collection<T> {
   public:
     // Initialize the dynamic array with a starting capacity
-    DynamicArray(int cap = DEFAULT_CAPACITY) {
-      capacity = cap;
-      backingStore = new T[capacity];
+    // which is never less than INLINE, and by default just INLINE if the
+    // array has any inline room
+    DynamicArray(int cap = INLINE > 0 ? INLINE : DEFAULT_CAPACITY) {
+      capacity = max(cap, INLINE);
+      backingStore = allocate(capacity);
     }
 
     // Erase the dynamic array
-    ~DynamicArray() { delete[] backingStore; }
+    ~DynamicArray() {
+      destroy(backingStore, backingStore + count);
+      deallocate(backingStore);
+    }
+
+    DynamicArray(const DynamicArray &) = delete;
+    DynamicArray &operator=(const DynamicArray &) = delete;
 
     // Find the index of a particular item
     // Return -1 if it is not found
@@ -68,25 +96,65 @@ namespace csi281 {
     }
 
     // Insert at the beginning of the collection
-    void insertAtBeginning(const T &item) {
-      insert(item, 0);
-    }
+    void insertAtBeginning(const T &item) { emplace(0, item); }
+    void insertAtBeginning(T &&item) { emplace(0, move(item)); }
 
     // Insert at the end of the collection
-    void insertAtEnd(const T &item) {
-      insert(item, count);
-    }
+    void insertAtEnd(const T &item) { emplace(count, item); }
+    void insertAtEnd(T &&item) { emplace(count, move(item)); }
 
     // Insert at a specific index
-    void insert(const T &item, int index) {
+    void insert(const T &item, int index) { emplace(index, item); }
+    void insert(T &&item, int index) { emplace(index, move(item)); }
+
+    // Construct an item in place at a specific index from the arguments
+    // to one of T's constructors
+    // *args* may refer to an item already in the array
+    // If a constructor throws while the array grows, the array is left as
+    // it was and nothing leaks
+    template <typename... Args> T &emplace(int index, Args &&...args) {
       assert(index >= 0 && index <= count); // Insertion index can be equal to count
       if (capacity == count) {
-        setCapacity(capacity * growthFactor);
+        // build the new item in the new store before the old one goes
+        int cap = max(capacity * growthFactor, 1);
+        T *destination = allocate(cap);
+        int built = 0;  // how many of the three steps below finished
+        try {
+          new (destination + index) T(forward<Args>(args)...);
+          built++;
+          transfer(backingStore, backingStore + index, destination);
+          built++;
+          transfer(backingStore + index, backingStore + count, destination + index + 1);
+        } catch (...) {
+          // transfer() cleans up after itself, so only the finished steps
+          // are undone
+          if (built >= 1) {
+            destination[index].~T();
+          }
+          if (built >= 2) {
+            destroy(destination, destination + index);
+          }
+          deallocate(destination);
+          throw;
+        }
+        replaceStore(destination, cap);
+        count++;
+      } else if (index == count) {
+        new (backingStore + count) T(forward<Args>(args)...);
+        count++;
+      } else {
+        T item(forward<Args>(args)...);
+        new (backingStore + count) T(move(backingStore[count - 1]));
+        count++;
+        move_backward(backingStore + index, backingStore + count - 2, backingStore + count - 1);
+        backingStore[index] = move(item);
       }
+      return backingStore[index];
+    }
 
-      moveDownFrom(index);
-      backingStore[index] = item;
-      count++;
+    // Construct an item in place at the end of the collection
+    template <typename... Args> T &emplaceAtEnd(Args &&...args) {
+      return emplace(count, forward<Args>(args)...);
     }
 
     // Remove the item at the beginning of the collection
@@ -99,39 +167,40 @@ namespace csi281 {
       assert(count > 0);
       // More efficient: no need to shift elements
       count--;
+      backingStore[count].~T();
     }
 
     // Remove the item at a specific index
     void removeAt(int index) {
       assert(index >= 0 && index < count);
       // Shift all elements after `index` one position to the left
-      // Corrected: loop condition should be `i < count - 1`
-      for (int i = index; i < count - 1; i++) {
-        backingStore[i] = backingStore[i + 1];
-      }
-      count--;
+      move(backingStore + index + 1, backingStore + count, backingStore + index);
+      removeAtEnd();
     }
 
     // Change the capacity of the dynamic array
+    // It is never less than INLINE, so shrinking to INLINE or below moves
+    // the items back inside the array
     // If it becomes less than count, just discard excess
     void setCapacity(int cap) {
       assert(cap >= 0);  // can't have negative capacity
+      cap = max(cap, INLINE);
       // don't do anything if we're already correct
       if (cap == capacity) {
         return;
       }
 
-      int numberToCopy = min(cap, count);
+      int numberToKeep = min(cap, count);
 
-      T *destination = new T[cap];
-
-      copy(backingStore, backingStore + numberToCopy, destination);
-      delete[] backingStore;
-      backingStore = destination;
-      capacity = cap;
-      if (capacity < count) {
-        count = capacity;
+      T *destination = allocate(cap);
+      try {
+        transfer(backingStore, backingStore + numberToKeep, destination);
+      } catch (...) {
+        deallocate(destination);
+        throw;
       }
+      replaceStore(destination, cap);
+      count = numberToKeep;
     }
 
     // Return the current capacity
@@ -144,15 +213,47 @@ namespace csi281 {
     int capacity;
     int growthFactor = 2;
     T *backingStore;
+    [[no_unique_address]] InlineStorage<T, INLINE> inlineStore;
+
+    // Uninitialized room for *cap* items, inside the array if it fits
+    T *allocate(int cap) {
+      if (cap <= INLINE) {
+        return inlineStore.items();
+      }
+      return static_cast<T *>(::operator new(sizeof(T) * cap));
+    }
 
-    // Shift all of the items in backingStore starting at
-    // index down by 1 place
-    // Make sure you have capacity available to do this before
-    // running this method
-    void moveDownFrom(int index) {
-      move_backward(backingStore + index, backingStore + count, backingStore + count + 1);
+    // Give back room from allocate()
+    void deallocate(T *store) {
+      if (store != inlineStore.items()) {
+        ::operator delete(store);
+      }
+    }
+
+    // Move the items in [first, last) into the uninitialized slots at
+    // *destination*, or copy them if a move could throw, so that a failed
+    // copy leaves the originals untouched
+    static void transfer(T *first, T *last, T *destination) {
+      if constexpr (is_nothrow_move_constructible_v<T> || !is_copy_constructible_v<T>) {
+        uninitialized_move(first, last, destination);
+      } else {
+        uninitialized_copy(first, last, destination);
+      }
+    }
+
+    // Destroy the items in backingStore and free it, then use
+    // *destination* of capacity *cap* instead
+    void replaceStore(T *destination, int cap) {
+      destroy(backingStore, backingStore + count);
+      deallocate(backingStore);
+      backingStore = destination;
+      capacity = cap;
     }
   };
+
+  // A DynamicArray that holds its first *N* items inline, so one that
+  // never grows past them makes no heap allocation at all
+  template <typename T, int N = 16> using SmallDynamicArray = DynamicArray<T, N>;
 }  // namespace csi281
 
 #endif /* dynamicarray_hpp */
\ No newline at end of file
@@ -29,29 +29,141 @@
 #define linkedlist_hpp
 
 #include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>  // for conditional_t, is_trivially_destructible_v
 
 #include "Collection.h"
 #include "MemoryLeakDetector.h"
+#include "NodePool.h"
 
 using namespace std;
 
 namespace csi281 {
-  template <typename T> class LinkedList : public Collection<T> {
+  // How the nodes of a LinkedList are linked together
+  // SINGLE links each node to the next one only
+  // DOUBLE also links it to the previous one, which costs a pointer per
+  // node but makes removeAtEnd() O(1) and lets cursors step backwards
+  enum class Links { SINGLE, DOUBLE };
+
+  // Nodes are made and freed by *Allocator* (see NodePool.h), one new
+  // and delete each by default; LinkedList<T, NodePool> takes them from
+  // slabs instead
+  template <typename T, template <typename> class Allocator = NodeAllocator,
+            Links LINKS = Links::SINGLE>
+  class LinkedList : public Collection<T> {
     class Node;  // forward declaration
   public:
+    static constexpr bool DOUBLY_LINKED = LINKS == Links::DOUBLE;
+
+    // A position in the list: at an item, or at end() just past the last
+    // one. Walking a list with a cursor, and inserting or erasing where it
+    // stands, is O(1) per step instead of counting from the head each time
+    // Changing the list other than through this cursor, including an insert
+    // or erase through another one next to its item, invalidates it
+    class Cursor {
+      friend class LinkedList;
+
+    public:
+      using iterator_category
+          = conditional_t<DOUBLY_LINKED, bidirectional_iterator_tag, forward_iterator_tag>;
+      using value_type = T;
+      using difference_type = ptrdiff_t;
+      using pointer = T *;
+      using reference = T &;
+
+      Cursor() = default;
+
+      T &operator*() const { return node->data; }
+      T *operator->() const { return &node->data; }
+
+      Cursor &operator++() {
+        previous = node;
+        node = node->next;
+        return *this;
+      }
+
+      Cursor operator++(int) {
+        Cursor old = *this;
+        ++*this;
+        return old;
+      }
+
+      // Only a doubly linked list can be walked backwards
+      Cursor &operator--() {
+        static_assert(DOUBLY_LINKED, "stepping back needs Links::DOUBLE");
+        node = before();
+        previous = node->previous;
+        return *this;
+      }
+
+      Cursor operator--(int) {
+        Cursor old = *this;
+        --*this;
+        return old;
+      }
+
+      bool operator==(const Cursor &other) const { return node == other.node; }
+      bool operator!=(const Cursor &other) const { return node != other.node; }
+
+    private:
+      Cursor(Node *node, Node *previous) : node(node), previous(previous) {}
+
+      // The node before this one, read from the node itself when it links
+      // back so a neighbour inserted through another cursor is seen
+      Node *before() const {
+        if constexpr (DOUBLY_LINKED) {
+          if (node != nullptr) return node->previous;
+        }
+        return previous;
+      }
+
+      Node *node = nullptr;      // nullptr at end()
+      Node *previous = nullptr;  // the node before, nullptr at the head
+    };
+
     // Erase all the nodes
+    // There is no need to visit them if the allocator frees them in bulk
+    // and their destructors do nothing
     ~LinkedList() {
-      Node *current = head;
-      while (current != nullptr) {
-        Node *last = current;
-        current = current->next;
-        delete last;
+      if constexpr (!Allocator<Node>::RELEASES_IN_BULK || !is_trivially_destructible_v<T>) {
+        Node *current = head;
+        while (current != nullptr) {
+          Node *last = current;
+          current = current->next;
+          allocator.destroy(last);
+        }
       }
       head = nullptr;
       tail = nullptr;
       count = 0;
     }
 
+    // Cursors at the first item and just past the last one, so a list can
+    // be used in a range-based for loop
+    Cursor begin() { return Cursor(head, nullptr); }
+    Cursor end() { return Cursor(nullptr, tail); }
+
+    // Insert *item* right after the one *position* is at, or at the
+    // beginning if *position* is end() of an empty list
+    // Return a cursor at the new item
+    Cursor insertAfter(Cursor position, const T &item) {
+      assert(position.node != nullptr || count == 0);  // can't insert after end()
+      Node *newNode = allocator.create(item);
+      link(position.node, newNode);
+      return Cursor(newNode, position.node);
+    }
+
+    // Remove the item *position* is at
+    // Return a cursor at the item that followed it
+    Cursor erase(Cursor position) {
+      assert(position.node != nullptr);  // can't erase end()
+      Node *next = position.node->next;
+      Node *before = position.before();
+      unlink(before);
+      return Cursor(next, before);
+    }
+
     // Find the index of a particular item
     // Return -1 if it is not found
     int find(const T &item) {
@@ -68,96 +180,76 @@ namespace csi281 {
     }
 
     // Get the item at a particular index
+    // The walk starts from whichever known node is closest: the head, the
+    // node the last get() landed on, or (doubly linked) the tail, so
+    // visiting indices in order is O(1) per get() rather than O(n)
     T &get(int index) {
       assert(index < count);  // can't get item off end
       assert(index >= 0);     // no negative indices
 
       Node *temp = head;
-      for (int i = 0; i < index; i++) {
+      int at = 0;
+      if (lastGot != nullptr && lastGotIndex <= index) {
+        temp = lastGot;
+        at = lastGotIndex;
+      }
+      if constexpr (DOUBLY_LINKED) {
+        int distance = index - at;
+        if (count - 1 - index < distance) {
+          temp = tail;
+          at = count - 1;
+          distance = at - index;
+        }
+        if (lastGot != nullptr && lastGotIndex > index && lastGotIndex - index < distance) {
+          temp = lastGot;
+          at = lastGotIndex;
+        }
+        for (; at > index; at--) {
+          temp = temp->previous;
+        }
+      }
+      for (; at < index; at++) {
         temp = temp->next;
       }
+      lastGot = temp;
+      lastGotIndex = index;
       return temp->data;
     }
 
     // Insert at the beginning of the collection
-    void insertAtBeginning(const T &item) {
-      Node *newNode = new Node(item);
-      newNode->next = head;
-      head = newNode;
-
-      if (count == 0) {
-        tail = head;
-      }
-      count++;
-    }
+    void insertAtBeginning(const T &item) { link(nullptr, allocator.create(item)); }
 
     // Insert at the end of the collection
-    void insertAtEnd(const T &item) {
-      Node *newNode = new Node(item);
-      if (count == 0) {
-        head = newNode;
-        tail = newNode;
-      } else {
-        tail->next = newNode;
-        tail = newNode;
-      }
-      count++;
-    }
+    void insertAtEnd(const T &item) { link(tail, allocator.create(item)); }
 
     // Insert at a specific index
     void insert(const T &item, int index) {
       assert(index <= count);  // can't insert off end
       assert(index >= 0);      // no negative indices
-      if (index == 0) {
-        insertAtBeginning(item);
-        return;
-      }
       if (index == count) {
         insertAtEnd(item);
         return;
       }
-      Node *current = head;
-      for (int i = 0; i < index - 1; i++) {
-          current = current->next;
-      }
-      Node *newNode = new Node(item);
-      newNode->next = current->next;
-      current->next = newNode;
-      count++;
+      link(index == 0 ? nullptr : nodeAt(index - 1), allocator.create(item));
     }
 
     // Remove the item at the beginning of the collection
     void removeAtBeginning() {
       assert(count > 0);
-
-      Node *temp = head;
-      head = head->next;
-      delete temp;
-      count--;
-      if (count == 0) {
-        tail = nullptr;
-      }
+      unlink(nullptr);
     }
 
     // Remove the item at the end of the collection
+    // O(1) when doubly linked, otherwise the second to last node has to
+    // be found by walking from the head
     void removeAtEnd() {
       assert(count > 0);
 
-      if (count == 1) {
-          removeAtBeginning();
-          return;
-      }
-
-      Node *current = head;
-      // Find the second to last node
-      while (current->next != tail) {
-        current = current->next;
+      if constexpr (DOUBLY_LINKED) {
+        unlink(tail->previous);
+      } else {
+        unlink(count == 1 ? nullptr : nodeAt(count - 2));
       }
-
-      delete tail;
-      tail = current;
-      tail->next = nullptr;
-      count--;
     }
 
     // Remove the item at a specific index
@@ -165,24 +257,11 @@ namespace csi281 {
       assert(index >= 0);
       assert(index < count);
       assert(count > 0);
-      if (index == 0) {
-        removeAtBeginning();
-        return;
-      }
-      if (index == (count - 1)) {
+      if (index == count - 1) {
         removeAtEnd();
         return;
       }
-
-      Node *current = head;
-      for (int i = 0; i < index - 1; i++) {
-          current = current->next;
-      }
-
-      Node *nodeToDelete = current->next;
-      current->next = nodeToDelete->next;
-      delete nodeToDelete;
-      count--;
+      unlink(index == 0 ? nullptr : nodeAt(index - 1));
     }
 
   protected:
@@ -191,18 +270,87 @@ namespace csi281 {
   private:
     Node *head = nullptr;
     Node *tail = nullptr;
+    // where the last get() landed, forgotten whenever the list changes
+    Node *lastGot = nullptr;
+    int lastGotIndex = 0;
+
+    // The back link of a node, which takes no room in a singly linked list
+    struct NoLink {};
 
     class Node {
       friend class LinkedList;
 
     public:
-      Node(const T &thing) : data(thing), next(nullptr){};
+      Node(const T &thing) : data(thing), next(nullptr), previous(){};
 
     private:
       T data;
       Node *next;
+      [[no_unique_address]] conditional_t<DOUBLY_LINKED, Node *, NoLink> previous;
     };
+
+    Allocator<Node> allocator;
+
+    // The node at *index*, walking from the head, or from the tail if the
+    // list is doubly linked and that is closer
+    Node *nodeAt(int index) {
+      if constexpr (DOUBLY_LINKED) {
+        if (index > count / 2) {
+          Node *current = tail;
+          for (int i = count - 1; i > index; i--) {
+            current = current->previous;
+          }
+          return current;
+        }
+      }
+      Node *current = head;
+      for (int i = 0; i < index; i++) {
+        current = current->next;
+      }
+      return current;
+    }
+
+    // Put *newNode* right after *before*, or at the head if it is nullptr
+    void link(Node *before, Node *newNode) {
+      Node *after = before == nullptr ? head : before->next;
+      newNode->next = after;
+      (before == nullptr ? head : before->next) = newNode;
+      if (after == nullptr) {
+        tail = newNode;
+      }
+      if constexpr (DOUBLY_LINKED) {
+        newNode->previous = before;
+        if (after != nullptr) {
+          after->previous = newNode;
+        }
+      }
+      lastGot = nullptr;
+      count++;
+    }
+
+    // Take out and free the node right after *before*, or the head if it
+    // is nullptr
+    void unlink(Node *before) {
+      Node *nodeToDelete = before == nullptr ? head : before->next;
+      Node *after = nodeToDelete->next;
+      (before == nullptr ? head : before->next) = after;
+      if (after == nullptr) {
+        tail = before;
+      }
+      if constexpr (DOUBLY_LINKED) {
+        if (after != nullptr) {
+          after->previous = before;
+        }
+      }
+      allocator.destroy(nodeToDelete);
+      lastGot = nullptr;
+      count--;
+    }
   };
+
+  // A LinkedList whose nodes also point back to the previous node
+  template <typename T, template <typename> class Allocator = NodeAllocator>
+  using DoublyLinkedList = LinkedList<T, Allocator, Links::DOUBLE>;
 }  // namespace csi281
 
 #endif /* linkedlist_hpp */
\ No newline at end of file
@@ -0,0 +1,299 @@
+//
+//  UnrolledLinkedList.h
+//
+//  This file defines an Unrolled Linked List class, a linked list that
+//  keeps a cache line of elements in each node.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef unrolledlinkedlist_hpp
+#define unrolledlinkedlist_hpp
+
+#include <cassert>
+#include <new>      // for placement new, launder()
+#include <utility>  // for move(), forward()
+
+#include "Collection.h"
+#include "MemoryLeakDetector.h"
+
+using namespace std;
+
+namespace csi281 {
+  // A linked list whose nodes each hold up to NODE_CAPACITY elements in
+  // an array, about one cache line of them, instead of a single element
+  // A scan reads whole nodes of contiguous elements and follows one
+  // pointer per node, and get() skips a node at a time, while inserting
+  // or removing in the middle still only shifts the elements of one node
+  // A full node is split in two to make room, and a node that drops below
+  // half full takes in the next one if they fit together, so nodes stay
+  // well filled and scans stay short
+  template <typename T> class UnrolledLinkedList : public Collection<T> {
+    class Node;  // forward declaration
+  public:
+    // Elements in each node: as many as fit in a 64 byte cache line, but
+    // never fewer than 4, so a node always has two halves to split into
+    static const int NODE_CAPACITY = 64 / sizeof(T) >= 4 ? static_cast<int>(64 / sizeof(T)) : 4;
+
+    UnrolledLinkedList() = default;
+    UnrolledLinkedList(const UnrolledLinkedList &) = delete;
+    UnrolledLinkedList &operator=(const UnrolledLinkedList &) = delete;
+
+    // Erase all the nodes
+    ~UnrolledLinkedList() {
+      Node *current = head;
+      while (current != nullptr) {
+        Node *last = current;
+        current = current->next;
+        delete last;
+      }
+      head = nullptr;
+      tail = nullptr;
+      count = 0;
+    }
+
+    // Find the index of a particular item
+    // Return -1 if it is not found
+    int find(const T &item) {
+      int index = 0;
+      for (Node *node = head; node != nullptr; node = node->next) {
+        T *items = node->items();
+        for (int i = 0; i < node->used; i++) {
+          if (items[i] == item) {
+            return index + i;
+          }
+        }
+        index += node->used;
+      }
+      return -1;
+    }
+
+    // Get the item at a particular index
+    T &get(int index) {
+      assert(index < count);  // can't get item off end
+      assert(index >= 0);     // no negative indices
+
+      Node *node = head;
+      while (index >= node->used) {
+        index -= node->used;
+        node = node->next;
+      }
+      return node->items()[index];
+    }
+
+    // Insert at the beginning of the collection
+    void insertAtBeginning(const T &item) { insert(item, 0); }
+
+    // Insert at the end of the collection
+    void insertAtEnd(const T &item) {
+      // a full tail gets a new node rather than being split, so a list
+      // built by appending has full nodes
+      if (tail == nullptr || tail->used == NODE_CAPACITY) {
+        appendNode();
+      }
+      tail->insert(tail->used, item);
+      count++;
+    }
+
+    // Insert at a specific index
+    void insert(const T &item, int index) {
+      assert(index <= count);  // can't insert off end
+      assert(index >= 0);      // no negative indices
+      if (index == count) {
+        insertAtEnd(item);
+        return;
+      }
+
+      // the node holding the item now at index
+      Node *node = head;
+      while (index >= node->used) {
+        index -= node->used;
+        node = node->next;
+      }
+      if (node->used == NODE_CAPACITY) {
+        // copy *item* first, since it may be an element the split moves
+        T element(item);
+        split(node);
+        if (index > node->used) {
+          index -= node->used;
+          node = node->next;
+        }
+        node->insert(index, move(element));
+      } else {
+        node->insert(index, item);
+      }
+      count++;
+    }
+
+    // Remove the item at the beginning of the collection
+    void removeAtBeginning() {
+      assert(count > 0);
+      removeAt(0);
+    }
+
+    // Remove the item at the end of the collection
+    void removeAtEnd() {
+      assert(count > 0);
+      removeAt(count - 1);
+    }
+
+    // Remove the item at a specific index
+    void removeAt(int index) {
+      assert(index >= 0);
+      assert(index < count);
+      assert(count > 0);
+
+      Node *previous = nullptr;
+      Node *node = head;
+      while (index >= node->used) {
+        index -= node->used;
+        previous = node;
+        node = node->next;
+      }
+      node->removeAt(index);
+      count--;
+
+      if (node->used == 0) {
+        unlink(previous, node);
+      } else if (node->used < NODE_CAPACITY / 2 && node->next != nullptr
+                 && node->used + node->next->used <= NODE_CAPACITY) {
+        // take over the next node's elements
+        Node *next = node->next;
+        T *items = next->items();
+        for (int i = 0; i < next->used; i++) {
+          node->insert(node->used, move(items[i]));
+        }
+        unlink(node, next);
+      }
+    }
+
+    // Return the number of nodes in the list
+    int getNodeCount() {
+      int nodes = 0;
+      for (Node *node = head; node != nullptr; node = node->next) {
+        nodes++;
+      }
+      return nodes;
+    }
+
+  protected:
+    using Collection<T>::count;
+
+  private:
+    Node *head = nullptr;
+    Node *tail = nullptr;
+
+    // Add an empty node after the tail
+    void appendNode() {
+      Node *newNode = new Node();
+      if (tail == nullptr) {
+        head = newNode;
+      } else {
+        tail->next = newNode;
+      }
+      tail = newNode;
+    }
+
+    // Move the upper half of the full *node* into a new node after it
+    void split(Node *node) {
+      Node *newNode = new Node();
+      int keep = NODE_CAPACITY / 2;
+      T *items = node->items();
+      for (int i = keep; i < NODE_CAPACITY; i++) {
+        newNode->insert(newNode->used, move(items[i]));
+      }
+      while (node->used > keep) {
+        node->removeAt(node->used - 1);
+      }
+      newNode->next = node->next;
+      node->next = newNode;
+      if (tail == node) {
+        tail = newNode;
+      }
+    }
+
+    // Delete *node*, which comes right after *previous* (nullptr for the head)
+    void unlink(Node *previous, Node *node) {
+      if (previous == nullptr) {
+        head = node->next;
+      } else {
+        previous->next = node->next;
+      }
+      if (tail == node) {
+        tail = previous;
+      }
+      delete node;
+    }
+
+    class Node {
+      friend class UnrolledLinkedList;
+
+    public:
+      Node() : used(0), next(nullptr){};
+      ~Node() {
+        T *elements = items();
+        for (int i = 0; i < used; i++) {
+          elements[i].~T();
+        }
+      }
+
+    private:
+      // The elements live in raw storage, constructed in place, so T
+      // needs no default constructor and unused slots hold no objects
+      alignas(T) unsigned char storage[NODE_CAPACITY * sizeof(T)];
+      int used;  // elements constructed at the front of storage
+      Node *next;
+
+      T *items() { return launder(reinterpret_cast<T *>(storage)); }
+
+      // Place *item* at *index*, moving the elements from there on up one
+      // There must be room for it
+      // *item* may be one of the elements, so it is copied before any move
+      template <typename U> void insert(const int index, U &&item) {
+        T *elements = items();
+        if (index == used) {
+          new (elements + index) T(forward<U>(item));
+        } else {
+          T element(forward<U>(item));
+          for (int i = used; i > index; i--) {
+            new (elements + i) T(move(elements[i - 1]));
+            elements[i - 1].~T();
+          }
+          new (elements + index) T(move(element));
+        }
+        used++;
+      }
+
+      // Destroy the element at *index*, moving the later ones down one
+      void removeAt(const int index) {
+        T *elements = items();
+        elements[index].~T();
+        for (int i = index; i < used - 1; i++) {
+          new (elements + i) T(move(elements[i + 1]));
+          elements[i + 1].~T();
+        }
+        used--;
+      }
+    };
+  };
+}  // namespace csi281
+
+#endif /* unrolledlinkedlist_hpp */
@@ -30,14 +30,15 @@
 
 #include <chrono>  // for nanoseconds
 #include <iostream>
-#include <random>
-#include <utility>  // for pair
+#include <array>
 
+#include "DataGenerator.h"
 #include "DynamicArray.h"
 #include "LinkedList.h"
 #include "MemoryLeakDetector.h"
 #include "PPlot.h"
 #include "SVGPainter.h"
+#include "UnrolledLinkedList.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -47,32 +48,32 @@ using namespace SVGChart;
 // Finds the speed of linear search
 // in a LinkedList and DynamicArray of *length* size
 // by running *numTests* and averaging them
-// Returns a pair indicating the average time it took
+// Returns an array of the average time it took
 // to do linear search in nanoseconds
-// LinkedList search should be first in the pair, and DynamicArray
-// should be second
+// LinkedList search should be first in the array, DynamicArray
+// second and UnrolledLinkedList third
 // Suggest using the facilities in STL <chrono>
-static pair<nanoseconds, nanoseconds> searchSpeed(const int length, const int numTests) {
+static array<nanoseconds, 3> searchSpeed(const int length, const int numTests) {
   // Generate Random Data Structures
   LinkedList<int> ll = LinkedList<int>();
   DynamicArray<int> da = DynamicArray<int>();
+  UnrolledLinkedList<int> ull = UnrolledLinkedList<int>();
 
-  // initialize random number generator in range min to max
-  random_device rd;
-  mt19937 rng(rd());
-  uniform_int_distribution<int> uni(0, length);
+  // seeded generator, so that runs can be repeated
+  DataGenerator &generator = sharedGenerator();
 
   // fill data structures with random data
   for (int i = 0; i < length; i++) {
-    int num = uni(rng);
+    int num = generator.next(0, length);
     ll.insertAtEnd(num);
     da.insertAtEnd(num);
+    ull.insertAtEnd(num);
   }
 
   // generate the testing array
   int *tests = new int[numTests];
   for (int i = 0; i < numTests; i++) {
-    tests[i] = uni(rng);
+    tests[i] = generator.next(0, length);
   }
 
   // test the linked list
@@ -98,8 +99,18 @@ static pair<nanoseconds, nanoseconds> searchSpeed(const int length, const int nu
   auto daSearchSpeed = (end - start) / numTests;
   // cout << "The dynamic array searches took on average " << daSearchSpeed << " nanoseconds\n";
 
+  // test the unrolled linked list
+
+  start = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+  for (int i = 0; i < numTests; i++) {
+    ull.contains(tests[i]);
+  }
+  end = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+
+  auto ullSearchSpeed = (end - start) / numTests;
+
   delete[] tests;
-  return pair<nanoseconds, nanoseconds>(llSearchSpeed, daSearchSpeed);
+  return {nanoseconds(llSearchSpeed), nanoseconds(daSearchSpeed), nanoseconds(ullSearchSpeed)};
 }
 
 // Draw a chart showing the average search times
@@ -128,19 +139,32 @@ static void drawSearchChart() {
   legend2->mName = "Dynamic Array";
   legend2->mColor = PColor(100, 20, 220);  // just an rgb value
 
+  PlotData *theX3 = new PlotData();
+  PlotData *theY3 = new PlotData();
+  LineDataDrawer *theDataDrawer3 = new LineDataDrawer();
+  theDataDrawer3->mDrawPoint = false;
+  theDataDrawer3->mDrawLine = true;
+
+  LegendData *legend3 = new LegendData();
+  legend3->mName = "Unrolled Linked List";
+  legend3->mColor = PColor(20, 160, 60);
+
   // cout << "Generating SVG data..." << endl;
 
   const int NUM_TESTS = 1000;
   for (int i = 1000; i <= 10000; i *= 2) {
     auto speeds = searchSpeed(i, NUM_TESTS);
     theX1->push_back(i);
-    theY1->push_back(speeds.first.count());
+    theY1->push_back(speeds[0].count());
     theX2->push_back(i);
-    theY2->push_back(speeds.second.count());
+    theY2->push_back(speeds[1].count());
+    theX3->push_back(i);
+    theY3->push_back(speeds[2].count());
   }
 
   pplot.mPlotDataContainer.AddXYPlot(theX1, theY1, legend1, theDataDrawer1);
   pplot.mPlotDataContainer.AddXYPlot(theX2, theY2, legend2, theDataDrawer2);
+  pplot.mPlotDataContainer.AddXYPlot(theX3, theY3, legend3, theDataDrawer3);
 
   pplot.mMargins.mLeft = 100;
   pplot.mMargins.mTop = 50;
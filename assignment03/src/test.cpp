@@ -32,10 +32,14 @@
 #define TEST_CASE(name, tags) DOCTEST_TEST_CASE(tags " " name)
 using doctest::Approx;
 
+#include <stdexcept>
 #include <string>
 
+#include "DataGenerator.h"
 #include "DynamicArray.h"
 #include "LinkedList.h"
+#include "NodePool.h"
+#include "UnrolledLinkedList.h"
 
 using namespace std;
 using namespace csi281;
@@ -50,6 +54,47 @@ public:
   unsigned int age = 0;
 };
 
+// Counts how it is constructed, to check what containers do with their items
+class Counted {
+public:
+  static inline int copies = 0;
+  static inline int moves = 0;
+  Counted(int v) : value(v){};
+  Counted(const Counted &other) : value(other.value) { copies++; }
+  Counted(Counted &&other) noexcept : value(other.value) { moves++; }
+  Counted &operator=(const Counted &other) {
+    value = other.value;
+    copies++;
+    return *this;
+  }
+  Counted &operator=(Counted &&other) noexcept {
+    value = other.value;
+    moves++;
+    return *this;
+  }
+  bool operator==(const Counted &other) const { return value == other.value; }
+  int value;
+};
+
+// Has no move constructor, so containers have to copy it, and its copies
+// throw once *copiesLeft* runs out; *live* counts the objects in existence
+class Fragile {
+public:
+  static inline int live = 0;
+  static inline int copiesLeft = 0;
+  Fragile(int v) : value(v) { live++; }
+  Fragile(const Fragile &other) : value(other.value) {
+    if (copiesLeft-- <= 0) {
+      throw runtime_error("copy failed");
+    }
+    live++;
+  }
+  Fragile &operator=(const Fragile &other) = default;
+  ~Fragile() { live--; }
+  bool operator==(const Fragile &other) const { return value == other.value; }
+  int value;
+};
+
 TEST_CASE("Linked List", "[LL]") {
   SECTION("int Test") {
     LinkedList<int> ll = LinkedList<int>();
@@ -158,6 +203,381 @@ TEST_CASE("Linked List", "[LL]") {
   }
 }
 
+TEST_CASE("Pooled Linked List", "[Pool]") {
+  SECTION("int Test") {
+    LinkedList<int, NodePool> ll = LinkedList<int, NodePool>();
+    for (int i = 0; i < 1000; i++) {
+      ll.insertAtEnd(i);
+    }
+    ll.removeAtBeginning();
+    ll.removeAt(500);
+    ll.insert(-1, 10);
+    ll.insertAtBeginning(-2);
+    CHECK(ll.getCount() == 1000);
+    CHECK(ll.get(0) == -2);
+    CHECK(ll.get(1) == 1);
+    CHECK(ll.get(11) == -1);
+    CHECK(ll.find(501) == -1);
+    CHECK(ll.find(999) == 999);
+    ll.removeAtEnd();
+    CHECK(ll.get(998) == 998);
+  }
+
+  SECTION("string test") {
+    LinkedList<string, NodePool> ll = LinkedList<string, NodePool>();
+    for (int i = 0; i < 100; i++) {
+      ll.insert(string(i, 'A'), 0);
+    }
+    ll.remove(string(50, 'A'));
+    ll.insertAtEnd("end");
+    CHECK(ll.getCount() == 100);
+    CHECK(ll.get(0) == string(99, 'A'));
+    CHECK(ll.contains(string(50, 'A')) == false);
+    CHECK(ll.get(99) == "end");
+  }
+
+  SECTION("allocation test") {
+    // a slab of nodes per allocation instead of one node
+    size_t before = get_allocation_count();
+    {
+      LinkedList<int, NodePool> ll = LinkedList<int, NodePool>();
+      for (int i = 0; i < 10000; i++) {
+        ll.insertAtEnd(i);
+      }
+      // freed nodes are reused before anything new is allocated
+      for (int i = 0; i < 5000; i++) {
+        ll.removeAtBeginning();
+        ll.insertAtBeginning(i);
+      }
+    }
+    CHECK(get_allocation_count() - before < 20);
+  }
+}
+
+TEST_CASE("Doubly Linked List", "[DLL]") {
+  SECTION("int Test") {
+    DoublyLinkedList<int> ll = DoublyLinkedList<int>();
+    for (int i = 0; i < 1000; i++) {
+      ll.insertAtEnd(i);
+    }
+    ll.removeAtBeginning();
+    ll.removeAt(500);
+    ll.insert(-1, 10);
+    ll.insertAtBeginning(-2);
+    CHECK(ll.getCount() == 1000);
+    CHECK(ll.get(0) == -2);
+    CHECK(ll.get(1) == 1);
+    CHECK(ll.get(11) == -1);
+    CHECK(ll.get(990) == 990);
+    CHECK(ll.get(12) == 11);
+    CHECK(ll.find(501) == -1);
+    CHECK(ll.find(999) == 999);
+    ll.removeAtEnd();
+    ll.removeAtEnd();
+    CHECK(ll.getCount() == 998);
+    CHECK(ll.get(997) == 997);
+    ll.insertAtEnd(1000);
+    CHECK(ll.get(998) == 1000);
+  }
+
+  SECTION("removeAtEnd test") {
+    // used as a stack from the back, down to empty and back up again
+    DoublyLinkedList<string, NodePool> ll = DoublyLinkedList<string, NodePool>();
+    for (int i = 0; i < 100; i++) {
+      ll.insertAtEnd(to_string(i));
+    }
+    for (int i = 99; i >= 0; i--) {
+      CHECK(ll.get(ll.getCount() - 1) == to_string(i));
+      ll.removeAtEnd();
+    }
+    CHECK(ll.getCount() == 0);
+    ll.insertAtEnd("again");
+    ll.insertAtBeginning("first");
+    CHECK(ll.get(0) == "first");
+    CHECK(ll.get(1) == "again");
+  }
+
+  SECTION("near the tail test") {
+    // walked to from the tail rather than the head
+    DoublyLinkedList<int> ll = DoublyLinkedList<int>();
+    for (int i = 0; i < 10; i++) {
+      ll.insert(i, ll.getCount());
+    }
+    ll.insert(100, 8);
+    ll.insert(200, 10);
+    ll.removeAt(7);
+    CHECK(ll.getCount() == 11);
+    int expected[11] = {0, 1, 2, 3, 4, 5, 6, 100, 8, 200, 9};
+    int matches = 0;
+    for (int i = 0; i < 11; i++) {
+      matches += ll.get(i) == expected[i];
+    }
+    CHECK(matches == 11);
+    CHECK(*prev(ll.end()) == 9);
+    CHECK(*prev(prev(ll.end())) == 200);
+  }
+
+  SECTION("indexed loop test") {
+    DoublyLinkedList<int> ll = DoublyLinkedList<int>();
+    for (int i = 0; i < 100; i++) {
+      ll.insertAtEnd(i);
+    }
+    int forward = 0;
+    for (int i = 0; i < ll.getCount(); i++) {
+      forward += ll.get(i) == i;
+    }
+    int backward = 0;
+    for (int i = ll.getCount() - 1; i >= 0; i--) {
+      backward += ll.get(i) == i;
+    }
+    CHECK(forward == 100);
+    CHECK(backward == 100);
+  }
+
+  SECTION("cursor test") {
+    DoublyLinkedList<int> ll = DoublyLinkedList<int>();
+    ll.insertAfter(ll.end(), 0);
+    auto cursor = ll.begin();
+    for (int i = 1; i < 10; i++) {
+      cursor = ll.insertAfter(cursor, i);
+    }
+    CHECK(ll.getCount() == 10);
+    CHECK(ll.get(9) == 9);
+    // erase the odd items while walking forwards
+    for (auto c = ll.begin(); c != ll.end();) {
+      c = *c % 2 == 1 ? ll.erase(c) : next(c);
+    }
+    CHECK(ll.getCount() == 5);
+    int expected = 8;
+    for (auto c = prev(ll.end());; --c) {
+      CHECK(*c == expected);
+      expected -= 2;
+      if (c == ll.begin()) {
+        break;
+      }
+    }
+    CHECK(expected == -2);
+    ll.erase(prev(ll.end()));
+    ll.insertAtEnd(10);
+    CHECK(ll.get(4) == 10);
+    CHECK(*prev(ll.end()) == 10);
+  }
+
+  SECTION("two cursors test") {
+    DoublyLinkedList<int> ll = DoublyLinkedList<int>();
+    for (int i = 1; i <= 3; i++) {
+      ll.insertAtEnd(i);
+    }
+    auto a = ll.begin();
+    auto b = next(a);
+    ll.insertAfter(a, 9);
+    // b was made before 9 went in just ahead of it
+    CHECK(*prev(b) == 9);
+    b = ll.erase(b);
+    CHECK(*b == 3);
+    CHECK(ll.getCount() == 3);
+    CHECK(ll.get(0) == 1);
+    CHECK(ll.get(1) == 9);
+    CHECK(ll.get(2) == 3);
+    CHECK(*prev(b) == 9);
+  }
+
+  SECTION("singly linked cursor test") {
+    LinkedList<int> ll = LinkedList<int>();
+    for (int i = 0; i < 10; i++) {
+      ll.insertAtEnd(i);
+    }
+    for (auto c = ll.begin(); c != ll.end(); ++c) {
+      if (*c == 4) {
+        c = ll.insertAfter(c, 40);
+      }
+    }
+    for (auto c = ll.begin(); c != ll.end();) {
+      c = *c == 9 || *c == 0 ? ll.erase(c) : next(c);
+    }
+    int sum = 0;
+    for (int item : ll) {
+      sum += item;
+    }
+    CHECK(ll.getCount() == 9);
+    CHECK(sum == 76);
+    CHECK(ll.get(4) == 40);
+    ll.insertAtEnd(9);
+    CHECK(ll.get(9) == 9);
+  }
+}
+
+TEST_CASE("Unrolled Linked List", "[ULL]") {
+  SECTION("int Test") {
+    UnrolledLinkedList<int> ll = UnrolledLinkedList<int>();
+    int sampleIntArray1[6] = {23, 4, 11, 4, 7, 8};
+    for (int &i : sampleIntArray1) {
+      ll.insertAtEnd(i);
+    }
+    CHECK(ll.getCount() == 6);
+    CHECK(ll.get(2) == 11);
+    CHECK(ll.find(7) == 4);
+    ll.removeAtBeginning();
+    CHECK(ll.get(0) == 4);
+    CHECK(ll.getCount() == 5);
+    for (int i = 0; i < 100; i++) {
+      ll.insert(i, 3);
+    }
+    CHECK(ll.get(1) == 11);
+    CHECK(ll.get(3) == 99);
+    CHECK(ll.get(102) == 0);
+    CHECK(ll.getCount() == 105);
+    ll.removeAtEnd();
+    CHECK(ll.getCount() == 104);
+    CHECK(ll.get(103) == 7);
+    CHECK(ll.get(0) == 4);
+    CHECK(ll.contains(50) == true);
+    ll.remove(50);
+    CHECK(ll.contains(50) == false);
+    CHECK(ll.getCount() == 103);
+    ll.insertAtBeginning(1023);
+    ll.insertAtBeginning(4324);
+    CHECK(ll.contains(4678) == false);
+    CHECK(ll.contains(1023) == true);
+    CHECK(ll.getCount() == 105);
+    CHECK(ll.get(0) == 4324);
+  }
+
+  SECTION("string test") {
+    UnrolledLinkedList<string> ll = UnrolledLinkedList<string>();
+    string sampleStringArray1[6] = {"hi", "b", "d", "wo", "t", "e"};
+    for (string &s : sampleStringArray1) {
+      ll.insertAtEnd(s);
+    }
+    CHECK(ll.getCount() == 6);
+    CHECK(ll.get(2) == "d");
+    CHECK(ll.find("t") == 4);
+    ll.removeAtBeginning();
+    CHECK(ll.get(0) == "b");
+    CHECK(ll.getCount() == 5);
+    for (int i = 0; i < 100; i++) {
+      ll.insert(string(i, 'A'), 3);
+    }
+    CHECK(ll.get(1) == "d");
+    CHECK(ll.get(3) == string(99, 'A'));
+    CHECK(ll.get(102) == "");
+    CHECK(ll.getCount() == 105);
+    ll.removeAtEnd();
+    CHECK(ll.getCount() == 104);
+    CHECK(ll.get(103) == "t");
+    CHECK(ll.get(0) == "b");
+    CHECK(ll.contains("AAAA") == true);
+    ll.remove("AAAAAAA");
+    CHECK(ll.contains("AAAAAAA") == false);
+    CHECK(ll.getCount() == 103);
+    ll.insertAtBeginning("Bob");
+    ll.insertAtBeginning("Mary");
+    CHECK(ll.contains("Sanford") == false);
+    CHECK(ll.contains("Bob") == true);
+    CHECK(ll.getCount() == 105);
+    CHECK(ll.get(0) == "Mary");
+  }
+
+  SECTION("Person test") {
+    UnrolledLinkedList<Person> ll = UnrolledLinkedList<Person>();
+    Person samplePersonArray1[2] = {Person("Drew", 65), Person("Ellen", 66)};
+    for (Person &p : samplePersonArray1) {
+      ll.insertAtEnd(p);
+    }
+    CHECK(ll.getCount() == 2);
+    CHECK(ll.get(1).age == 66);
+    CHECK(ll.find(Person("Drew", 65)) == 0);
+    ll.removeAtBeginning();
+    CHECK(ll.get(0) == Person("Ellen", 66));
+    CHECK(ll.getCount() == 1);
+    for (int i = 0; i < 100; i++) {
+      ll.insert(Person("Clone", 18), 1);
+    }
+    CHECK(ll.get(1).name == "Clone");
+    CHECK(ll.get(3) == Person("Clone", 18));
+    CHECK(ll.get(100) == Person("Clone", 18));
+    CHECK(ll.getCount() == 101);
+    ll.removeAtEnd();
+    CHECK(ll.getCount() == 100);
+    CHECK(ll.get(99) == Person("Clone", 18));
+    CHECK(ll.get(0) == Person("Ellen", 66));
+    CHECK(ll.contains(Person("Ellen", 66)) == true);
+    CHECK(ll.contains(Person("Clone", 18)) == true);
+    ll.remove(Person("Ellen", 66));
+    CHECK(ll.contains(Person("Ellen", 66)) == false);
+    CHECK(ll.getCount() == 99);
+    ll.insertAtBeginning(Person("Matteo", 23));
+    ll.insertAtBeginning(Person("Sarah", 33));
+    CHECK(ll.contains(Person("Drew", 65)) == false);
+    CHECK(ll.contains(Person("Matteo", 23)) == true);
+    CHECK(ll.getCount() == 101);
+    CHECK(ll.get(0) == Person("Sarah", 33));
+  }
+
+  SECTION("node boundaries test") {
+    // every kind of change, checked against a plain array after each one
+    UnrolledLinkedList<int> ull = UnrolledLinkedList<int>();
+    const int maxLength = 500;
+    int expected[maxLength];
+    int length = 0;
+    DataGenerator generator(281);
+    for (int step = 0; step < 3000; step++) {
+      int choice = generator.next(0, 5);
+      int index = length == 0 ? 0 : generator.next(0, length - 1);
+      if (length < maxLength && (choice < 3 || length == 0)) {
+        // insert at the beginning, end or a random place
+        index = choice == 0 ? 0 : (choice == 1 ? length : index);
+        for (int i = length; i > index; i--) {
+          expected[i] = expected[i - 1];
+        }
+        expected[index] = step;
+        length++;
+        ull.insert(step, index);
+      } else {
+        index = choice == 3 ? 0 : (choice == 4 ? length - 1 : index);
+        for (int i = index; i < length - 1; i++) {
+          expected[i] = expected[i + 1];
+        }
+        length--;
+        ull.removeAt(index);
+      }
+      REQUIRE(ull.getCount() == length);
+      if (step % 100 == 0 || length < 40) {
+        for (int i = 0; i < length; i++) {
+          REQUIRE(ull.get(i) == expected[i]);
+        }
+      }
+    }
+    for (int i = 0; i < length; i++) {
+      REQUIRE(ull[i] == expected[i]);
+      REQUIRE(ull.find(expected[i]) == i);
+    }
+    // nodes stay well filled
+    REQUIRE(ull.getNodeCount() <= 2 * length / (UnrolledLinkedList<int>::NODE_CAPACITY / 2) + 1);
+  }
+
+  SECTION("own element test") {
+    // long enough that a moved-from string is left empty
+    UnrolledLinkedList<string> ull = UnrolledLinkedList<string>();
+    ull.insertAtEnd(string(40, 'a'));
+    ull.insertAtEnd(string(40, 'b'));
+    ull.insert(ull[0], 0);
+    CHECK(ull[0] == string(40, 'a'));
+    CHECK(ull[1] == string(40, 'a'));
+    while (ull.getCount() < UnrolledLinkedList<string>::NODE_CAPACITY) {
+      ull.insertAtEnd(string(40, 'c'));
+    }
+    // into a full node, which is split first
+    const int last = ull.getCount() - 1;
+    ull.insert(ull[last], 1);
+    CHECK(ull.getCount() == last + 2);
+    CHECK(ull[1] == string(40, 'c'));
+    CHECK(ull[last + 1] == string(40, 'c'));
+    ull.insert(ull[2], 0);
+    CHECK(ull[0] == string(40, 'a'));
+  }
+}
+
 TEST_CASE("Dynamic Array", "[DA]") {
   SECTION("int Test") {
     DynamicArray<int> da = DynamicArray<int>();
@@ -279,4 +699,151 @@ TEST_CASE("Dynamic Array", "[DA]") {
     CHECK(da.getCount() == 3);
     CHECK(da[2] == 2);
   }
+
+  SECTION("move test") {
+    // no default constructor needed, and growth moves rather than copies
+    Counted::copies = 0;
+    DynamicArray<Counted> da = DynamicArray<Counted>(1);
+    for (int i = 0; i < 100; i++) {
+      da.emplaceAtEnd(i);
+    }
+    da.insertAtBeginning(Counted(-1));
+    da.emplace(50, -2);
+    CHECK(Counted::copies == 0);
+    CHECK(da.getCount() == 102);
+    CHECK(da.get(0).value == -1);
+    CHECK(da.get(50).value == -2);
+    CHECK(da.get(101).value == 99);
+    da.removeAt(50);
+    CHECK(da.find(Counted(-2)) == -1);
+    Counted copy(7);
+    da.insertAtEnd(copy);
+    CHECK(Counted::copies == 1);
+
+    // inserting a copy of one of its own items, while the array grows
+    DynamicArray<string> strings = DynamicArray<string>(2);
+    strings.insertAtEnd(string(40, 'x'));
+    strings.insertAtEnd("y");
+    strings.insert(strings[0], 1);
+    strings.insert(strings[2], 0);
+    CHECK(strings.getCount() == 4);
+    CHECK(strings[0] == "y");
+    CHECK(strings[1] == string(40, 'x'));
+    CHECK(strings[2] == string(40, 'x'));
+    CHECK(strings[3] == "y");
+    strings.setCapacity(1);
+    CHECK(strings.getCount() == 1);
+    strings.insertAtEnd("z");
+    CHECK(strings[1] == "z");
+
+    DynamicArray<Person> people = DynamicArray<Person>(0);
+    people.emplaceAtEnd("Drew", 65);
+    people.emplace(0, "Ellen", 66);
+    CHECK(people.getCount() == 2);
+    CHECK(people[0] == Person("Ellen", 66));
+    CHECK(people[1].age == 65);
+  }
+
+  SECTION("exception test") {
+    Fragile::live = 0;
+    {
+      DynamicArray<Fragile> da = DynamicArray<Fragile>(4);
+      for (int i = 0; i < 4; i++) {
+        da.emplaceAtEnd(i);
+      }
+      // growing copies every item, and the third copy fails
+      Fragile::copiesLeft = 2;
+      CHECK_THROWS(da.emplace(2, 4));
+      CHECK(da.getCount() == 4);
+      CHECK(da.getCapacity() == 4);
+      CHECK(Fragile::live == 4);
+      Fragile::copiesLeft = 1;
+      CHECK_THROWS(da.setCapacity(8));
+      CHECK(Fragile::live == 4);
+      // the new item itself fails to be built
+      Fragile extra(9);
+      Fragile::copiesLeft = 0;
+      CHECK_THROWS(da.insertAtEnd(extra));
+      CHECK(Fragile::live == 5);
+      CHECK(da[3].value == 3);
+      Fragile::copiesLeft = 100;
+      da.insert(extra, 0);
+      CHECK(da.getCount() == 5);
+      CHECK(da[0].value == 9);
+      CHECK(da[4].value == 3);
+    }
+    CHECK(Fragile::live == 0);
+  }
+}
+
+TEST_CASE("Small Dynamic Array", "[SDA]") {
+  SECTION("int Test") {
+    SmallDynamicArray<int, 8> da = SmallDynamicArray<int, 8>();
+    int sampleIntArray1[6] = {23, 4, 11, 4, 7, 8};
+    for (int &i : sampleIntArray1) {
+      da.insertAtEnd(i);
+    }
+    CHECK(da.getCount() == 6);
+    CHECK(da.get(2) == 11);
+    CHECK(da.find(7) == 4);
+    da.removeAtBeginning();
+    CHECK(da.get(0) == 4);
+    CHECK(da.getCount() == 5);
+    for (int i = 0; i < 100; i++) {
+      da.insert(i, 3);
+    }
+    CHECK(da.get(1) == 11);
+    CHECK(da.get(3) == 99);
+    CHECK(da.get(102) == 0);
+    CHECK(da.getCount() == 105);
+    da.removeAtEnd();
+    CHECK(da.get(103) == 7);
+    da.remove(50);
+    CHECK(da.contains(50) == false);
+    CHECK(da.getCount() == 103);
+  }
+
+  SECTION("allocation test") {
+    // nothing on the heap until the inline items run out
+    size_t before = get_allocation_count();
+    {
+      SmallDynamicArray<int> da = SmallDynamicArray<int>();
+      CHECK(da.getCapacity() == 16);
+      for (int i = 0; i < 16; i++) {
+        da.insertAtBeginning(i);
+      }
+      da.removeAt(3);
+      CHECK(da.get(3) == 11);
+      CHECK(get_allocation_count() == before);
+      da.insertAtEnd(16);
+      da.insertAtEnd(17);
+      CHECK(da.getCapacity() == 32);
+      CHECK(get_allocation_count() == before + 1);
+    }
+    // used through the Collection interface
+    SmallDynamicArray<int, 4> small = SmallDynamicArray<int, 4>();
+    Collection<int> &collection = small;
+    collection.insertAtEnd(1);
+    collection.insertAtBeginning(0);
+    CHECK(collection.get(1) == 1);
+    CHECK(get_allocation_count() == before + 1);
+  }
+
+  SECTION("capacity test") {
+    SmallDynamicArray<string, 4> da = SmallDynamicArray<string, 4>(2);
+    CHECK(da.getCapacity() == 4);
+    for (int i = 0; i < 10; i++) {
+      da.insertAtEnd(string(i + 20, 'A'));
+    }
+    CHECK(da.getCapacity() == 16);
+    // back inside the array, keeping as many items as fit
+    da.setCapacity(0);
+    CHECK(da.getCapacity() == 4);
+    CHECK(da.getCount() == 4);
+    CHECK(da[3] == string(23, 'A'));
+    da.insertAtBeginning("spill");
+    CHECK(da.getCapacity() == 8);
+    CHECK(da[0] == "spill");
+    CHECK(da[4] == string(23, 'A'));
+  }
 }
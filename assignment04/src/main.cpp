@@ -32,8 +32,8 @@
 #include <array>
 #include <chrono>  // for microseconds
 #include <iostream>
-#include <random>
 
+#include "DataGenerator.h"
 #include "MemoryLeakDetector.h"
 #include "PPlot.h"
 #include "SVGPainter.h"
@@ -53,14 +53,12 @@ static array<long long, 4> sortSpeed(const int length) {
   int *testArray3 = new int[length];
   int *testArray4 = new int[length];
 
-  // initialize random number generator in range min to max
-  random_device rd;
-  mt19937 rng(rd());
-  uniform_int_distribution<int> uni(0, length);
+  // seeded generator, so that runs can be repeated
+  DataGenerator &generator = sharedGenerator();
 
   // fill data structures with random data
   for (int i = 0; i < length; i++) {
-    int num = uni(rng);
+    int num = generator.next(0, length);
     testArray1[i] = num;
     testArray2[i] = num;
     testArray3[i] = num;
@@ -29,6 +29,9 @@
 #define sort_hpp
 
 #include <algorithm>  // for swap()
+#include <cstddef>    // for ptrdiff_t
+#include <iterator>   // for ssize()
+#include <span>
 
 #include "MemoryLeakDetector.h"
 
@@ -38,12 +41,12 @@ namespace csi281 {
 
   // Performs an in-place ascending sort of *array* of size *length*
   // using the bubble sort algorithm
-  template <typename T> void bubbleSort(T array[], const int length) {
+  template <typename T> void bubbleSort(T array[], const ptrdiff_t length) {
     bool swapped = true;
     while (swapped)
     {
       swapped = false;
-      for (int i = 0; i < length - 1; i++)
+      for (ptrdiff_t i = 0; i < length - 1; i++)
       {
         if (array[i] > array[i + 1])
         {
@@ -56,10 +59,10 @@ namespace csi281 {
 
   // Performs an in-place ascending sort of *array* of size *length*
   // using the selection sort algorithm
-  template <typename T> void selectionSort(T array[], const int length) {
-    for (int i = 1; i < length; i++)
+  template <typename T> void selectionSort(T array[], const ptrdiff_t length) {
+    for (ptrdiff_t i = 1; i < length; i++)
     {
-      for (int j = i; j > 0; j--)
+      for (ptrdiff_t j = i; j > 0; j--)
       {
         if (array[j] < array[j - 1])
         {
@@ -71,11 +74,11 @@ namespace csi281 {
 
   // Performs an in-place ascending sort of *array* of size *length*
   // using the insertion sort algorithm
-  template <typename T> void insertionSort(T array[], const int length) {
-    int indexSmallest = 0, indexSorted = 0;
+  template <typename T> void insertionSort(T array[], const ptrdiff_t length) {
+    ptrdiff_t indexSmallest = 0, indexSorted = 0;
     while (indexSorted < length)
     {
-      for (int i = indexSorted; i < length; i++)
+      for (ptrdiff_t i = indexSorted; i < length; i++)
       {
         if (array[i] < array[indexSmallest])
         {
@@ -87,6 +90,19 @@ namespace csi281 {
       indexSmallest = indexSorted;
     }
   }
+
+  // Performs the sorts above on a whole std::span
+  template <typename T, size_t N> void bubbleSort(span<T, N> array) {
+    bubbleSort(array.data(), ssize(array));
+  }
+
+  template <typename T, size_t N> void selectionSort(span<T, N> array) {
+    selectionSort(array.data(), ssize(array));
+  }
+
+  template <typename T, size_t N> void insertionSort(span<T, N> array) {
+    insertionSort(array.data(), ssize(array));
+  }
 }  // namespace csi281
 
 #endif /* sort_hpp */
@@ -36,9 +36,11 @@ using doctest::Approx;
 #include <chrono>     // for microseconds
 #include <iostream>
 #include <iterator>  // for begin() and end()
-#include <random>
+#include <span>
 #include <string>
+#include <vector>
 
+#include "DataGenerator.h"
 #include "sort.h"
 
 using namespace std;
@@ -74,11 +76,9 @@ TEST_CASE("Bubble Sort", "[Bubble]") {
     const int length = 100;
     int sampleIntArray1[length];
     int sampleIntArray2[length];
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(-length, length);
+    DataGenerator &generator = sharedGenerator();
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(-length, length);
       sampleIntArray1[i] = num;
       sampleIntArray2[i] = num;
     }
@@ -141,11 +141,9 @@ TEST_CASE("Selection Sort", "[Selection]") {
     const int length = 100;
     int sampleIntArray1[length];
     int sampleIntArray2[length];
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(-length, length);
+    DataGenerator &generator = sharedGenerator();
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(-length, length);
       sampleIntArray1[i] = num;
       sampleIntArray2[i] = num;
     }
@@ -208,11 +206,9 @@ TEST_CASE("Insertion Sort", "[Insertion]") {
     const int length = 100;
     int sampleIntArray1[length];
     int sampleIntArray2[length];
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(-length, length);
+    DataGenerator &generator = sharedGenerator();
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(-length, length);
       sampleIntArray1[i] = num;
       sampleIntArray2[i] = num;
     }
@@ -250,6 +246,27 @@ TEST_CASE("Insertion Sort", "[Insertion]") {
   }
 }
 
+TEST_CASE("Span Overloads", "[Span]") {
+  SECTION("vector and subspan Test") {
+    vector<int> expected = {23, -3, -2, 4, 11, 4, 7, 8, 0, 0, -3};
+    sort(expected.begin(), expected.end());
+    vector<int> bubble = {23, -3, -2, 4, 11, 4, 7, 8, 0, 0, -3};
+    vector<int> selection = bubble, insertion = bubble;
+    bubbleSort(span(bubble));
+    selectionSort(span(selection));
+    insertionSort(span(insertion));
+    REQUIRE(bubble == expected);
+    REQUIRE(selection == expected);
+    REQUIRE(insertion == expected);
+
+    // only the middle is sorted
+    int partial[6] = {9, 5, 3, 4, 1, 0};
+    insertionSort(span(partial).subspan(1, 4));
+    int partialSorted[6] = {9, 1, 3, 4, 5, 0};
+    REQUIRE(equal(begin(partial), end(partial), begin(partialSorted)));
+  }
+}
+
 TEST_CASE("Speed Comparison", "[Speed]") {
   const int length = 2048;
   // Generate Random Data Structures
@@ -257,14 +274,12 @@ TEST_CASE("Speed Comparison", "[Speed]") {
   int *testArray2 = new int[length];
   int *testArray3 = new int[length];
 
-  // initialize random number generator in range min to max
-  random_device rd;
-  mt19937 rng(rd());
-  uniform_int_distribution<int> uni(0, length);
+  // seeded generator, so that runs can be repeated
+  DataGenerator &generator = sharedGenerator();
 
   // fill data structures with random data
   for (int i = 0; i < length; i++) {
-    int num = uni(rng);
+    int num = generator.next(0, length);
     testArray1[i] = num;
     testArray2[i] = num;
     testArray3[i] = num;
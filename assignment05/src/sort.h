@@ -32,8 +32,11 @@
 #define sort_hpp
 
 #include <algorithm>  // for swap(), merge()
-#include <random>
+#include <cstddef>    // for ptrdiff_t
+#include <iterator>   // for ssize()
+#include <span>
 
+#include "DataGenerator.h"
 #include "MemoryLeakDetector.h"
 
 using namespace std;
@@ -47,12 +50,12 @@ namespace csi281 {
   // *end* will be the length of the array - 1 for a first run
   // NOTE: Your solution MUST use std::inplace_merge
   // http://www.cplusplus.com/reference/algorithm/inplace_merge/
-  template <typename T> void mergeSort(T array[], const int start, const int end) {
+  template <typename T> void mergeSort(T array[], const ptrdiff_t start, const ptrdiff_t end) {
     // Base case: Continue as long as there is more than one element.
     // If start >= end, the segment has 0 or 1 elements, which is already sorted.
     if (start < end)
     {
-      int middle = start + (end - start) / 2;
+      ptrdiff_t middle = start + (end - start) / 2;
       mergeSort(array, start, middle);
       mergeSort(array, middle + 1, end);
 
@@ -60,23 +63,18 @@ namespace csi281 {
     }
   }
 
-  // setup random number generator
-  static random_device rd;
-  static mt19937 rng(rd());
-  // you can use uniform_int_distribution and rng to create
-  // a random int in a certain range
-
   // partition
   // I took heavy inspiration from the examples on gameguild.gg
-  template <typename T> int partition(T array[], const int start, const int end)
+  template <typename T> ptrdiff_t partition(T array[], const ptrdiff_t start, const ptrdiff_t end)
   {
-    uniform_int_distribution<int> uni(start, end);
-    int pivotIndex = uni(rng);
+    // a random pivot from the shared generator, so CSI281_SEED repeats a run
+    uint64_t width = static_cast<uint64_t>(end - start + 1);
+    ptrdiff_t pivotIndex = start + static_cast<ptrdiff_t>(sharedGenerator().engine().below(width));
     swap(array[start], array[pivotIndex]);
 
-    int pivot = start;
-    int left = start + 1;
-    int right = end;
+    ptrdiff_t pivot = start;
+    ptrdiff_t left = start + 1;
+    ptrdiff_t right = end;
 
     while (left <= right)
     {
@@ -106,10 +104,10 @@ namespace csi281 {
   // TIP: It may be helpful to swap the pivot to the end,
   // sort the center of the range, and then move the pivot back to
   // the appropriate place
-  template <typename T> void quickSort(T array[], const int start, const int end) {
+  template <typename T> void quickSort(T array[], const ptrdiff_t start, const ptrdiff_t end) {
     if (start < end)
     {
-      int pivot = partition(array, start, end);
+      ptrdiff_t pivot = partition(array, start, end);
       quickSort(array, start, pivot - 1);
       quickSort(array, pivot + 1, end);
     }
@@ -127,13 +125,13 @@ namespace csi281 {
   // as described below
   // NOTE: You will need to modify the implementation to only
   // sort part of the array as per the parameters of this version
-  template <typename T> void insertionSort(T array[], const int start, const int end) {
+  template <typename T> void insertionSort(T array[], const ptrdiff_t start, const ptrdiff_t end) {
     if (end + 1 <= 1)
       return;
 
-    for (int i = start + 1; i < end + 1; i++)
+    for (ptrdiff_t i = start + 1; i < end + 1; i++)
     {
-      for (int j = i; j > start; j--)
+      for (ptrdiff_t j = i; j > start; j--)
       {
         if (array[j] < array[j - 1])
         {
@@ -152,7 +150,7 @@ namespace csi281 {
   // *end* will be the length of the array - 1 for a first run
   // TIP: You can copy your implementation of merge sort in here, and
   // should be able to call the insertionSort above
-  template <typename T> void hybridSort(T array[], const int start, const int end) {
+  template <typename T> void hybridSort(T array[], const ptrdiff_t start, const ptrdiff_t end) {
     // Base case for recursion: if the partition is invalid or has one element, it's sorted.
     if (start >= end) {
       return;
@@ -165,7 +163,7 @@ namespace csi281 {
     // Otherwise, merge sort for larger arrays
     else
     {
-      int middle = start + (end - start) / 2;
+      ptrdiff_t middle = start + (end - start) / 2;
 
       // Recursively sort the two halves.
       hybridSort(array, start, middle);
@@ -175,6 +173,23 @@ namespace csi281 {
       std::inplace_merge(array + start, array + middle + 1, array + end + 1);
     }
   }
+
+  // Sorts a whole std::span, from 0 to its size - 1
+  template <typename T, size_t N> void mergeSort(span<T, N> array) {
+    mergeSort(array.data(), 0, ssize(array) - 1);
+  }
+
+  template <typename T, size_t N> void quickSort(span<T, N> array) {
+    quickSort(array.data(), 0, ssize(array) - 1);
+  }
+
+  template <typename T, size_t N> void insertionSort(span<T, N> array) {
+    insertionSort(array.data(), 0, ssize(array) - 1);
+  }
+
+  template <typename T, size_t N> void hybridSort(span<T, N> array) {
+    hybridSort(array.data(), 0, ssize(array) - 1);
+  }
 }  // namespace csi281
 
 #endif /* sort_hpp */
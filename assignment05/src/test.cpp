@@ -36,9 +36,11 @@ using doctest::Approx;
 #include <chrono>     // for microseconds
 #include <iostream>
 #include <iterator>  // for begin() and end()
-#include <random>
+#include <span>
 #include <string>
+#include <vector>
 
+#include "DataGenerator.h"
 #include "sort.h"
 
 using namespace std;
@@ -74,11 +76,9 @@ TEST_CASE("Merge Sort", "[Merge]") {
     const int length = 100;
     int sampleIntArray1[length];
     int sampleIntArray2[length];
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(-length, length);
+    DataGenerator &generator = sharedGenerator();
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(-length, length);
       sampleIntArray1[i] = num;
       sampleIntArray2[i] = num;
     }
@@ -141,11 +141,9 @@ TEST_CASE("Quicksort", "[Quick]") {
     const int length = 100;
     int sampleIntArray1[length];
     int sampleIntArray2[length];
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(-length, length);
+    DataGenerator &generator = sharedGenerator();
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(-length, length);
       sampleIntArray1[i] = num;
       sampleIntArray2[i] = num;
     }
@@ -208,11 +206,9 @@ TEST_CASE("Insertion Sort", "[Insertion]") {
     const int length = 100;
     int sampleIntArray1[length];
     int sampleIntArray2[length];
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(-length, length);
+    DataGenerator &generator = sharedGenerator();
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(-length, length);
       sampleIntArray1[i] = num;
       sampleIntArray2[i] = num;
     }
@@ -292,11 +288,9 @@ TEST_CASE("Hybrid Sort", "[Hybrid]") {
     const int length = 100;
     int sampleIntArray1[length];
     int sampleIntArray2[length];
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(-length, length);
+    DataGenerator &generator = sharedGenerator();
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(-length, length);
       sampleIntArray1[i] = num;
       sampleIntArray2[i] = num;
     }
@@ -334,6 +328,30 @@ TEST_CASE("Hybrid Sort", "[Hybrid]") {
   }
 }
 
+TEST_CASE("Span Overloads", "[Span]") {
+  SECTION("vector and subspan Test") {
+    vector<int> expected = {23, -3, -2, 4, 11, 4, 7, 8, 0, 0, -3, 15, 2, 9};
+    sort(expected.begin(), expected.end());
+    vector<int> merge = {23, -3, -2, 4, 11, 4, 7, 8, 0, 0, -3, 15, 2, 9};
+    vector<int> quick = merge, insertion = merge, hybrid = merge;
+    mergeSort(span(merge));
+    quickSort(span(quick));
+    insertionSort(span(insertion));
+    hybridSort(span(hybrid));
+    REQUIRE(merge == expected);
+    REQUIRE(quick == expected);
+    REQUIRE(insertion == expected);
+    REQUIRE(hybrid == expected);
+
+    // only the middle is sorted, and empty spans are left alone
+    int partial[6] = {9, 5, 3, 4, 1, 0};
+    hybridSort(span(partial).subspan(1, 4));
+    quickSort(span(partial).subspan(0, 0));
+    int partialSorted[6] = {9, 1, 3, 4, 5, 0};
+    REQUIRE(equal(begin(partial), end(partial), begin(partialSorted)));
+  }
+}
+
 TEST_CASE("Speed Comparison", "[Speed]") {
   const int length = 2048;
 
@@ -343,14 +361,12 @@ TEST_CASE("Speed Comparison", "[Speed]") {
   int *testArray3 = new int[length];
   int *testArray4 = new int[length];
 
-  // initialize random number generator in range min to max
-  random_device rd;
-  mt19937 rng(rd());
-  uniform_int_distribution<int> uni(0, length);
+  // seeded generator, so that runs can be repeated
+  DataGenerator &generator = sharedGenerator();
 
   // fill data structures with random data
   for (int i = 0; i < length; i++) {
-    int num = uni(rng);
+    int num = generator.next(0, length);
     testArray1[i] = num;
     testArray2[i] = num;
     testArray3[i] = num;
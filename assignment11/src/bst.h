@@ -34,14 +34,18 @@
 #include <list>
 #include <optional>
 #include <random>
+#include <type_traits>  // for is_trivially_destructible_v
 
 #include "MemoryLeakDetector.h"
+#include "NodePool.h"
 
 using namespace std;
 
 namespace csi281 {
 
-  template <typename T> class BST {
+  // Nodes are made and freed by *Allocator* (see NodePool.h), one new
+  // and delete each by default; BST<T, NodePool> takes them from slabs
+  template <typename T, template <typename> class Allocator = NodeAllocator> class BST {
   public:
     // *Node* represents one node in the tree
     struct Node {
@@ -58,11 +62,17 @@ namespace csi281 {
       }
       deleteHelper(node->left);
       deleteHelper(node->right);
-      delete node;
+      allocator.destroy(node);
     }
 
     // Delete all nodes
-    ~BST() { deleteHelper(root); }
+    // There is no need to visit them if the allocator frees them in bulk
+    // and their destructors do nothing
+    ~BST() {
+      if constexpr (!Allocator<Node>::RELEASES_IN_BULK || !is_trivially_destructible_v<T>) {
+        deleteHelper(root);
+      }
+    }
 
     // Add a new node to the tree with *key*
     // Make sure to insert it into the correct place
@@ -73,7 +83,7 @@ namespace csi281 {
     void insert(T key) {
       // If the tree is empty, create a new node and make it the root.
       if (root == nullptr) {
-        root = new Node(key, nullptr, nullptr);
+        root = allocator.create(key, nullptr, nullptr);
         count++;
         return;
       }
@@ -83,7 +93,7 @@ namespace csi281 {
         // If the key is less than or equal to the current node's key, go left.
         if (key <= current->key) {
           if (current->left == nullptr) {
-            current->left = new Node(key, nullptr, nullptr);
+            current->left = allocator.create(key, nullptr, nullptr);
             count++;
             return;
           }
@@ -91,7 +101,7 @@ namespace csi281 {
         } else {
           // Otherwise, go right.
           if (current->right == nullptr) {
-            current->right = new Node(key, nullptr, nullptr);
+            current->right = allocator.create(key, nullptr, nullptr);
             count++;
             return;
           }
@@ -167,6 +177,7 @@ namespace csi281 {
   private:
     Node *root = nullptr;
     int count = 0;
+    Allocator<Node> allocator;
   };
 
 }  // namespace csi281
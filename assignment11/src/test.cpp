@@ -36,9 +36,10 @@ using doctest::Approx;
 #include <chrono>     // for microseconds
 #include <iostream>
 #include <iterator>  // for begin() and end()
-#include <random>
 #include <string>
 
+#include "DataGenerator.h"
+#include "NodePool.h"
 #include "bst.h"
 #include "timing.h"
 
@@ -138,12 +139,10 @@ TEST_CASE("random BST<int> test", "[rand BST<int>]") {
   // setup
   const int length = 20;
   int *sampleIntArray1 = new int[length];
-  // initialize random number generator in range min to max
-  random_device rd;
-  mt19937 rng(rd());
-  uniform_int_distribution<int> uni(0, length);
+  // random numbers from the shared generator in range min to max
+  DataGenerator &generator = sharedGenerator();
   for (int i = 0; i < length; i++) {
-    int num = uni(rng);
+    int num = generator.next(0, length);
     sampleIntArray1[i] = num;
   }
 
@@ -181,6 +180,42 @@ TEST_CASE("random BST<int> test", "[rand BST<int>]") {
   delete[] sampleIntArray1;
 }
 
+TEST_CASE("pooled BST test", "[pool BST]") {
+  SECTION("same walk as the default allocator") {
+    BST<int> bst = BST<int>();
+    BST<int, NodePool> pooled = BST<int, NodePool>();
+    DataGenerator &generator = sharedGenerator();
+    for (int i = 0; i < 2000; i++) {
+      int key = generator.next(0, 499);
+      bst.insert(key);
+      pooled.insert(key);
+    }
+    list<int> expected, walked;
+    bst.inOrderWalk(expected);
+    pooled.inOrderWalk(walked);
+    CHECK(expected == walked);
+    CHECK(pooled.getCount() == 2000);
+    CHECK(pooled.contains(17) == bst.contains(17));
+    CHECK(pooled.minimum() == bst.minimum());
+    CHECK(pooled.maximum() == bst.maximum());
+  }
+
+  SECTION("strings and allocations") {
+    size_t before = get_allocation_count();
+    {
+      BST<string, NodePool> bst = BST<string, NodePool>();
+      for (int i = 0; i < 1000; i++) {
+        bst.insert(to_string(i * 7 % 1000));
+      }
+      CHECK(bst.contains("994"));
+      CHECK(bst.minimum() == "0");
+    }
+    // the keys are short enough to be stored inside the strings, so
+    // only the slabs are allocated
+    CHECK(get_allocation_count() - before < 20);
+  }
+}
+
 TEST_CASE("BST<int> timing test", "[time BST<int>]") {
   // setup
   const int length = 16384;
@@ -34,8 +34,8 @@
 #include <algorithm>  // for find()
 #include <array>
 #include <chrono>  // for microseconds
-#include <random>
 
+#include "DataGenerator.h"
 #include "MemoryLeakDetector.h"
 
 using namespace std;
@@ -49,14 +49,12 @@ namespace csi281 {
     int *testArray1 = new int[length];
     int *testArray2 = new int[length];
 
-    // initialize random number generator in range min to max
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(0, length);
+    // seeded generator, so that runs can be repeated
+    DataGenerator &generator = sharedGenerator();
 
     // fill data structures with random data
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(0, length);
       testArray1[i] = num;
       testArray2[i] = num;
     }
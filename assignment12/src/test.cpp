@@ -36,9 +36,9 @@ using doctest::Approx;
 #include <chrono>     // for microseconds
 #include <iostream>
 #include <iterator>  // for begin() and end()
-#include <random>
 #include <string>
 
+#include "DataGenerator.h"
 #include "PriorityQueue.h"
 #include "timing.h"
 
@@ -121,12 +121,10 @@ TEST_CASE("random PriorityQueue<int> test", "[rand PriorityQueue<int>]") {
   // setup
   const int length = 20;
   int *sampleIntArray1 = new int[length];
-  // initialize random number generator in range min to max
-  random_device rd;
-  mt19937 rng(rd());
-  uniform_int_distribution<int> uni(0, length);
+  // random numbers from the shared generator in range min to max
+  DataGenerator &generator = sharedGenerator();
   for (int i = 0; i < length; i++) {
-    int num = uni(rng);
+    int num = generator.next(0, length);
     sampleIntArray1[i] = num;
   }
 
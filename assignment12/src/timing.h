@@ -33,9 +33,9 @@
 
 #include <array>
 #include <chrono>  // for microseconds
-#include <random>
 #include <vector>
 
+#include "DataGenerator.h"
 #include "MemoryLeakDetector.h"
 #include "PriorityQueue.h"
 
@@ -50,14 +50,12 @@ namespace csi281 {
     vector<int> testVector;
     PriorityQueue<int> pq = PriorityQueue<int>();
 
-    // initialize random number generator in range min to max
-    random_device rd;
-    mt19937 rng(rd());
-    uniform_int_distribution<int> uni(0, length);
+    // seeded generator, so that runs can be repeated
+    DataGenerator &generator = sharedGenerator();
 
     // fill data structures with random data
     for (int i = 0; i < length; i++) {
-      int num = uni(rng);
+      int num = generator.next(0, length);
       testVector.push_back(num);
       pq.push(num);
     }
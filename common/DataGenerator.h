@@ -0,0 +1,285 @@
+//
+//  DataGenerator.h
+//
+//  Fast, seeded generation of bulk test data in the distributions the
+//  timing helpers of every assignment need, so that runs are reproducible.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef DataGenerator_hpp
+#define DataGenerator_hpp
+
+#include <cmath>  // for log(), pow()
+#include <cstdint>
+#include <cstdlib>  // for getenv(), strtoull()
+#include <limits>
+
+#include "MemoryLeakDetector.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Seed used when none is given
+  const uint64_t DEFAULT_SEED = 281;
+
+  // The xoshiro256** generator of Blackman and Vigna: 256 bits of state,
+  // excellent statistical quality and a few instructions per number
+  // It meets the requirements of a standard library random number engine,
+  // so it also works with the distributions in <random>
+  class Xoshiro256 {
+  public:
+    using result_type = uint64_t;
+
+    // The state is expanded from *seed* with splitmix64, as the authors
+    // recommend, so nearby seeds still give unrelated sequences
+    explicit Xoshiro256(uint64_t seed = DEFAULT_SEED) {
+      for (uint64_t &word : _state) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        word = z ^ (z >> 31);
+      }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+      uint64_t result = rotateLeft(_state[1] * 5, 7) * 9;
+      uint64_t t = _state[1] << 17;
+      _state[2] ^= _state[0];
+      _state[3] ^= _state[1];
+      _state[1] ^= _state[2];
+      _state[0] ^= _state[3];
+      _state[2] ^= t;
+      _state[3] = rotateLeft(_state[3], 45);
+      return result;
+    }
+
+    // A number in [0, *bound*), by Lemire's multiply and shift, which
+    // has no division and (for bounds below 2^32) negligible bias
+    uint64_t below(const uint64_t bound) {
+      if (bound <= numeric_limits<uint32_t>::max()) {
+        return (((*this)() >> 32) * bound) >> 32;
+      }
+      return (*this)() % bound;
+    }
+
+    // A number in [0, 1) with all 53 bits of a double's precision
+    double unit() { return ((*this)() >> 11) * 0x1.0p-53; }
+
+  private:
+    static uint64_t rotateLeft(const uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t _state[4];
+  };
+
+  // Shapes of data the generator can produce
+  enum class Distribution {
+    UNIFORM,     // every value in the range equally likely
+    ZIPFIAN,     // the smallest values far more likely, as in skewed real world keys
+    SORTED,      // uniform values in ascending order
+    REVERSED,    // uniform values in descending order
+    FEW_UNIQUE,  // a handful of distinct values, each repeated many times
+    CLUSTERED    // values bunched into a few narrow bands across the range
+  };
+
+  // Fills arrays of ints with values between min and max (inclusive) in
+  // one of the shapes above, using a Xoshiro256 seeded once; the same
+  // seed and sequence of calls always produces the same data
+  class DataGenerator {
+  public:
+    // Distinct values used by FEW_UNIQUE
+    static const int FEW_UNIQUE_VALUES = 16;
+    // Bands used by CLUSTERED, each 1/CLUSTER_SPREAD of the range wide
+    static const int NUM_CLUSTERS = 8;
+    static const int CLUSTER_SPREAD = 256;
+    // Skew of ZIPFIAN; the value ranked r comes up in proportion to 1/r^ZIPF_THETA
+    static constexpr double ZIPF_THETA = 0.99;
+
+    explicit DataGenerator(const uint64_t seed = DEFAULT_SEED) : _engine(seed) {}
+
+    // A single uniform value between *min* and *max*
+    int next(const int min, const int max) {
+      return static_cast<int>(min + static_cast<long long>(_engine.below(rangeWidth(min, max))));
+    }
+
+    // Fill the *length* ints of *array* with values between *min* and *max*
+    void fill(int array[], const int length, const int min, const int max,
+              const Distribution distribution = Distribution::UNIFORM) {
+      switch (distribution) {
+        case Distribution::UNIFORM:
+          for (int i = 0; i < length; i++) {
+            array[i] = next(min, max);
+          }
+          break;
+        case Distribution::ZIPFIAN:
+          fillZipfian(array, length, min, max);
+          break;
+        case Distribution::SORTED:
+          fillSorted(array, length, min, max, false);
+          break;
+        case Distribution::REVERSED:
+          fillSorted(array, length, min, max, true);
+          break;
+        case Distribution::FEW_UNIQUE: {
+          int values[FEW_UNIQUE_VALUES];
+          for (int &value : values) {
+            value = next(min, max);
+          }
+          for (int i = 0; i < length; i++) {
+            array[i] = values[_engine.below(FEW_UNIQUE_VALUES)];
+          }
+          break;
+        }
+        case Distribution::CLUSTERED: {
+          uint64_t width = rangeWidth(min, max) / CLUSTER_SPREAD + 1;
+          long long centers[NUM_CLUSTERS];
+          for (long long &center : centers) {
+            center = next(min, max);
+          }
+          for (int i = 0; i < length; i++) {
+            long long value = centers[_engine.below(NUM_CLUSTERS)]
+                              + static_cast<long long>(_engine.below(width))
+                              - static_cast<long long>(width / 2);
+            array[i] = static_cast<int>(value < min ? min : (value > max ? max : value));
+          }
+          break;
+        }
+      }
+    }
+
+    // A new int array (to be released with delete[]) of *length* values
+    // filled as fill() does
+    int *generate(const int length, const int min, const int max,
+                  const Distribution distribution = Distribution::UNIFORM) {
+      int *array = new int[length];
+      fill(array, length, min, max, distribution);
+      return array;
+    }
+
+    Xoshiro256 &engine() { return _engine; }
+
+  private:
+    // Terms of the Zipfian normalizing sum added one by one; wider ranges
+    // estimate the rest in closed form
+    static constexpr uint64_t ZETA_EXACT_TERMS = 1000000;
+
+    // How many values lie between *min* and *max* inclusive
+    static uint64_t rangeWidth(const int min, const int max) {
+      return static_cast<uint64_t>(static_cast<long long>(max) - min) + 1;
+    }
+
+    // Sorted uniform values in one pass, without sorting: the gaps
+    // between n sorted uniform values are distributed like n + 1
+    // exponential gaps scaled to the range. A copy of the engine gives
+    // the total of the gaps first, then the engine replays them
+    void fillSorted(int array[], const int length, const int min, const int max,
+                    const bool descending) {
+      Xoshiro256 replay = _engine;
+      double total = 0;
+      for (int i = 0; i <= length; i++) {
+        total -= log(1.0 - replay.unit());
+      }
+      const long long width = static_cast<long long>(rangeWidth(min, max));
+      double scale = static_cast<double>(width) / total;
+      double position = 0;
+      for (int i = 0; i < length; i++) {
+        position -= log(1.0 - _engine.unit());
+        long long offset = static_cast<long long>(position * scale);
+        int value = static_cast<int>(min + (offset < width ? offset : width - 1));
+        array[descending ? length - 1 - i : i] = value;
+      }
+      _engine();  // the last gap, so the engine ends where the replay did
+    }
+
+    // The sum of 1/i^ZIPF_THETA for i from 1 to *n*: exact up to
+    // ZETA_EXACT_TERMS, then the Euler-Maclaurin estimate of the rest, which
+    // is well within a double's precision that far out
+    static double zeta(const uint64_t n) {
+      const uint64_t exact = n < ZETA_EXACT_TERMS ? n : ZETA_EXACT_TERMS;
+      double sum = 0;
+      for (uint64_t i = 1; i <= exact; i++) {
+        sum += 1.0 / pow(static_cast<double>(i), ZIPF_THETA);
+      }
+      if (n > exact) {
+        // terms exact + 1 to n: the integral of x^-theta from exact to n,
+        // plus the trapezoid and first derivative corrections
+        auto f = [](const double x) { return pow(x, -ZIPF_THETA); };
+        auto slope = [](const double x) { return -ZIPF_THETA * pow(x, -ZIPF_THETA - 1.0); };
+        const double m = static_cast<double>(exact);
+        const double x = static_cast<double>(n);
+        sum += (pow(x, 1.0 - ZIPF_THETA) - pow(m, 1.0 - ZIPF_THETA)) / (1.0 - ZIPF_THETA)
+               + (f(x) - f(m)) / 2.0 + (slope(x) - slope(m)) / 12.0;
+      }
+      return sum;
+    }
+
+    // Values ranked by popularity with the method of Gray et al. ("Quickly
+    // Generating Billion-Record Synthetic Databases"), as used by YCSB;
+    // min is the most popular value, min + 1 the next and so on
+    void fillZipfian(int array[], const int length, const int min, const int max) {
+      uint64_t n = rangeWidth(min, max);
+      if (n != _zipfItems) {
+        // the normalizing sum costs up to ZETA_EXACT_TERMS pow() calls, so
+        // keep it for the next call
+        _zipfItems = n;
+        _zipfZeta = zeta(n);
+      }
+      double zeta2 = 1.0 + pow(0.5, ZIPF_THETA);
+      double alpha = 1.0 / (1.0 - ZIPF_THETA);
+      double eta = (1.0 - pow(2.0 / n, 1.0 - ZIPF_THETA)) / (1.0 - zeta2 / _zipfZeta);
+      for (int i = 0; i < length; i++) {
+        double u = _engine.unit();
+        double uz = u * _zipfZeta;
+        uint64_t rank;
+        if (uz < 1.0) {
+          rank = 0;
+        } else if (uz < zeta2) {
+          rank = 1;
+        } else {
+          rank = static_cast<uint64_t>(n * pow(eta * u - eta + 1.0, alpha));
+        }
+        array[i] = static_cast<int>(min + static_cast<long long>(rank < n ? rank : n - 1));
+      }
+    }
+
+    Xoshiro256 _engine;
+    uint64_t _zipfItems = 0;  // range the Zipfian sum was computed for
+    double _zipfZeta = 0;     // sum of 1/i^ZIPF_THETA for i up to _zipfItems
+  };
+
+  // The generator the timing helpers of every assignment share, seeded
+  // from the CSI281_SEED environment variable if it is set so a run can
+  // be repeated exactly (DEFAULT_SEED otherwise)
+  inline DataGenerator &sharedGenerator() {
+    static DataGenerator generator([] {
+      const char *seed = getenv("CSI281_SEED");
+      return seed != nullptr ? strtoull(seed, nullptr, 10) : DEFAULT_SEED;
+    }());
+    return generator;
+  }
+}  // namespace csi281
+
+#endif /* DataGenerator_hpp */
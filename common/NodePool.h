@@ -0,0 +1,160 @@
+//
+//  NodePool.h
+//
+//  Allocators for the nodes of linked structures: one that calls new and
+//  delete for every node, and a pool that carves nodes out of large slabs.
+//
+//  Copyright 2019 David Kopec
+//
+//  Permission is hereby granted, free of charge, to any person
+//  obtaining a copy of this software and associated documentation files
+//  (the "Software"), to deal in the Software without restriction,
+//  including without limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of the Software,
+//  and to permit persons to whom the Software is furnished to do so,
+//  subject to the following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+//  OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+//  THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+//  OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+//  ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef NodePool_hpp
+#define NodePool_hpp
+
+#include <cstddef>  // for max_align_t
+#include <new>      // for placement new
+#include <utility>  // for forward()
+
+#include "MemoryLeakDetector.h"
+
+using namespace std;
+
+namespace csi281 {
+
+  // Containers such as LinkedList and BST take one of these as a template
+  // parameter, applied to their own node type, and make and free every
+  // node through it:
+  //   Node *create(args...)     constructs a node from *args*
+  //   void destroy(Node *node)  destroys a node made by create()
+  //   RELEASES_IN_BULK          true if destroying the allocator frees the
+  //                             memory of every node it made, so a container
+  //                             being destroyed only has to run the nodes'
+  //                             destructors, or nothing if they are trivial
+
+  // Every node is its own new and delete
+  template <typename Node> class NodeAllocator {
+  public:
+    static constexpr bool RELEASES_IN_BULK = false;
+
+    template <typename... Args> Node *create(Args &&...args) {
+      return new Node(forward<Args>(args)...);
+    }
+
+    void destroy(Node *node) { delete node; }
+  };
+
+  // Hands out nodes from slabs of many nodes each, so a container makes
+  // one allocation (and, with the leak detector on, one map insert) per
+  // slab instead of per node. A destroyed node's slot goes on a free list
+  // threaded through the free slots themselves and is reused first;
+  // otherwise nodes come in order from the newest slab. Slabs start at
+  // FIRST_SLAB_NODES nodes and double up to MAX_SLAB_NODES, so a small
+  // container wastes little. Memory only goes back when the pool is
+  // destroyed (or release() is called), all slabs at once
+  template <typename Node> class NodePool {
+  public:
+    static constexpr bool RELEASES_IN_BULK = true;
+    static const int FIRST_SLAB_NODES = 16;
+    static const int MAX_SLAB_NODES = 4096;
+
+    NodePool() = default;
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+    ~NodePool() { release(); }
+
+    template <typename... Args> Node *create(Args &&...args) {
+      static_assert(alignof(Node) <= alignof(max_align_t), "over-aligned nodes are not supported");
+      return new (allocate()) Node(forward<Args>(args)...);
+    }
+
+    void destroy(Node *node) {
+      node->~Node();
+      Slot *slot = reinterpret_cast<Slot *>(node);
+      slot->next = freeList;
+      freeList = slot;
+    }
+
+    // Free every slab; nodes still in them are not destroyed, so they must
+    // have been destroyed already or have trivial destructors
+    void release() {
+      while (slabs != nullptr) {
+        Slab *next = slabs->next;
+        ::operator delete(slabs);
+        slabs = next;
+      }
+      freeList = nullptr;
+      unused = nullptr;
+      unusedEnd = nullptr;
+      nextSlabNodes = FIRST_SLAB_NODES;
+      slabCount = 0;
+    }
+
+    // Number of slabs allocated so far
+    int getSlabCount() const { return slabCount; }
+
+  private:
+    // A node's worth of memory, which holds the next free slot while unused
+    union Slot {
+      Slot *next;
+      alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    // Each slab starts with this header, followed by its slots
+    struct Slab {
+      Slab *next;  // the slab allocated before this one
+    };
+
+    // Bytes from the start of a slab to its first slot
+    static constexpr size_t HEADER_BYTES
+        = (sizeof(Slab) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+
+    void *allocate() {
+      if (freeList != nullptr) {
+        Slot *slot = freeList;
+        freeList = slot->next;
+        return slot;
+      }
+      if (unused == unusedEnd) {
+        addSlab();
+      }
+      return unused++;
+    }
+
+    void addSlab() {
+      void *memory = ::operator new(HEADER_BYTES + nextSlabNodes * sizeof(Slot));
+      Slab *slab = static_cast<Slab *>(memory);
+      slab->next = slabs;
+      slabs = slab;
+      unused = reinterpret_cast<Slot *>(static_cast<unsigned char *>(memory) + HEADER_BYTES);
+      unusedEnd = unused + nextSlabNodes;
+      nextSlabNodes = nextSlabNodes * 2 <= MAX_SLAB_NODES ? nextSlabNodes * 2 : MAX_SLAB_NODES;
+      slabCount++;
+    }
+
+    Slab *slabs = nullptr;      // newest slab, linked to the older ones
+    Slot *freeList = nullptr;   // slots of destroyed nodes, ready for reuse
+    Slot *unused = nullptr;     // next never used slot of the newest slab
+    Slot *unusedEnd = nullptr;  // end of the newest slab
+    int nextSlabNodes = FIRST_SLAB_NODES;  // size of the next slab
+    int slabCount = 0;
+  };
+}  // namespace csi281
+
+#endif /* NodePool_hpp */